@@ -0,0 +1,778 @@
+// Timing driver for the BinTree class.
+// Builds large random key sets and compares alternative ways of loading and
+// querying a tree. Not part of the assignment driver in lab2.cpp.
+//
+// Build with optimizations on, e.g.:
+//    g++ -O2 -pthread bench.cpp bintree.cpp nodedata.cpp bloomfilter.cpp
+//        frozenindex.cpp eytzingerindex.cpp karyindex.cpp vebindex.cpp
+//        btree.cpp bufferpool.cpp pagedtree.cpp radixtree.cpp mappedfile.cpp
+//        treeloader.cpp tokenscanner.cpp ingestdriver.cpp
+
+#include "bintree.h"
+#include "btree.h"
+#include "eytzingerindex.h"
+#include "frozenindex.h"
+#include "ingestdriver.h"
+#include "keywordset.h"
+#include "karyindex.h"
+#include "pagedtree.h"
+#include "radixtree.h"
+#include "treeloader.h"
+#include "vebindex.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int DEFAULT_KEYS = 200000;      // keys per benchmark unless overridden
+const int SORTED_INSERT_KEYS = 20000; // plain insert of sorted keys is O(n^2)
+const double ZIPF_SKEW = 1.0;         // exponent of the Zipfian traces
+const char PAGE_FILE[] = "bench.pages"; // scratch file for the paged tree
+const char TOKEN_FILE[] = "bench.tokens"; // scratch file in lab2's format
+const char SNAPSHOT_FILE[] = "bench.snapshot"; // scratch tree snapshot
+const int TOKENS_PER_LINE = 1000;     // tokens before each "$$"
+
+// the keys lab2 probes, as a set built by the compiler
+constexpr const char* LAB2_KEYS[] = { "not", "and", "sss", "e", "m", "t" };
+constexpr KeywordSet<6> LAB2_SET = makeKeywordSet(LAB2_KEYS);
+static_assert(LAB2_SET.contains("sss", 3) && !LAB2_SET.contains("ss", 2),
+   "keyword set must be usable at compile time");
+
+//global function prototypes
+vector<string> makeKeys(int, unsigned);            // random lowercase tokens
+vector<NodeData*> makeData(const vector<string>&); // one NodeData per key
+double elapsedMs(chrono::steady_clock::time_point);// ms since a start time
+void benchBulkLoad(const vector<string>&);         // insert vs bulkLoad
+void benchRetrieveBatch(const vector<string>&);    // retrieve vs batch
+void benchFilter(const vector<string>&);           // misses with a filter
+void benchSortedStream(const vector<string>&);     // insert vs hint/Builder
+vector<int> makeZipfTrace(int, int, double, unsigned); // skewed key indexes
+void benchSplay(const vector<string>&);            // plain vs splay on Zipf
+void benchFrozen(const vector<string>&);           // tree vs frozen indexes
+void benchBTree(const vector<string>&);            // BinTree vs BTree
+void benchPaged(const vector<string>&);            // paged tree, pool sizes
+void benchRadix(const vector<string>&);            // BinTree vs RadixTree
+void benchKeywords(const vector<string>&);         // BinTree vs KeywordSet
+void writeTokenFile(const vector<string>&);        // keys in lab2's format
+void benchLoad(const vector<string>&);             // >> vs mapped loader
+void benchIngest(const vector<string>&);           // ingest, 1 vs n threads
+void benchSnapshot(const vector<string>&);         // text rebuild vs load
+
+int main(int argc, char* argv[]) {
+   int count = (argc > 1 ? atoi(argv[1]) : DEFAULT_KEYS);
+   if (count <= 0) {
+      cout << "Key count must be positive." << endl;
+      return 1;
+   }
+
+   vector<string> keys = makeKeys(count, 343);
+   cout << "Keys: " << count << endl;
+   benchBulkLoad(keys);
+   benchRetrieveBatch(keys);
+   benchFilter(keys);
+   benchSortedStream(keys);
+   benchSplay(keys);
+   benchFrozen(keys);
+   benchBTree(keys);
+   benchPaged(keys);
+   benchRadix(keys);
+   benchKeywords(keys);
+   benchLoad(keys);
+   benchIngest(keys);
+   benchSnapshot(keys);
+   return 0;
+}
+
+//----------------------------------------------------------------------------
+// makeKeys
+// random tokens of 1 to 12 lowercase letters, duplicates are possible
+
+vector<string> makeKeys(int count, unsigned seed) {
+   mt19937 gen(seed);
+   uniform_int_distribution<int> length(1, 12);
+   uniform_int_distribution<int> letter('a', 'z');
+   vector<string> keys;
+   keys.reserve(count);
+   for (int i = 0; i < count; i++) {
+      string s(length(gen), ' ');
+      for (char& c : s) {
+         c = static_cast<char>(letter(gen));
+      }
+      keys.push_back(s);
+   }
+   return keys;
+}
+
+//----------------------------------------------------------------------------
+// makeData
+// caller owns the returned NodeData objects
+
+vector<NodeData*> makeData(const vector<string>& keys) {
+   vector<NodeData*> batch;
+   batch.reserve(keys.size());
+   for (const string& s : keys) {
+      batch.push_back(new NodeData(s));
+   }
+   return batch;
+}
+
+//----------------------------------------------------------------------------
+// elapsedMs
+
+double elapsedMs(chrono::steady_clock::time_point start) {
+   chrono::duration<double, milli> d = chrono::steady_clock::now() - start;
+   return d.count();
+}
+
+//----------------------------------------------------------------------------
+// benchBulkLoad
+// one insert per token (as buildTree does) against a single bulkLoad
+
+void benchBulkLoad(const vector<string>& keys) {
+   BinTree T;
+   vector<NodeData*> batch = makeData(keys);
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   for (NodeData* ptr : batch) {
+      if (!T.insert(ptr)) {
+         delete ptr;                       // duplicate case, not inserted
+      }
+   }
+   double insertMs = elapsedMs(start);
+   T.makeEmpty();
+
+   batch = makeData(keys);
+   start = chrono::steady_clock::now();
+   int distinct = T.bulkLoad(batch.data(), static_cast<int>(batch.size()));
+   double bulkMs = elapsedMs(start);
+
+   cout << "repeated insert:  " << insertMs << " ms" << endl;
+   cout << "bulkLoad:         " << bulkMs << " ms (" << distinct
+        << " distinct)" << endl;
+}
+
+//----------------------------------------------------------------------------
+// benchRetrieveBatch
+// one retrieve per query against retrieveBatch, half the queries miss
+
+void benchRetrieveBatch(const vector<string>& keys) {
+   BinTree T;
+   vector<NodeData*> batch = makeData(keys);
+   T.bulkLoad(batch.data(), static_cast<int>(batch.size()));
+
+   vector<string> misses = makeKeys(static_cast<int>(keys.size()), 8675309);
+   vector<NodeData> queries;
+   queries.reserve(2 * keys.size());
+   for (size_t i = 0; i < keys.size(); i++) {
+      queries.push_back(NodeData(keys[i]));
+      queries.push_back(NodeData(misses[i]));
+   }
+   int count = static_cast<int>(queries.size());
+
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   int found = 0;
+   for (const NodeData& nd : queries) {
+      NodeData* p;
+      found += (T.retrieve(nd, p) ? 1 : 0);
+   }
+   double singleMs = elapsedMs(start);
+
+   vector<NodeData*> results(count);
+   start = chrono::steady_clock::now();
+   int batchFound = T.retrieveBatch(queries.data(), count, results.data());
+   double batchMs = elapsedMs(start);
+
+   cout << "retrieve:         " << singleMs << " ms (" << found
+        << " found)" << endl;
+   cout << "retrieveBatch:    " << batchMs << " ms (" << batchFound
+        << " found)" << endl;
+}
+
+//----------------------------------------------------------------------------
+// benchFilter
+// retrieve of keys that are mostly absent, without and with a Bloom filter
+
+void benchFilter(const vector<string>& keys) {
+   BinTree T;
+   vector<NodeData*> batch = makeData(keys);
+   T.bulkLoad(batch.data(), static_cast<int>(batch.size()));
+
+   vector<string> probes = makeKeys(static_cast<int>(keys.size()), 31337);
+   vector<NodeData> queries(probes.begin(), probes.end());
+   for (int pass = 0; pass < 2; pass++) {
+      if (pass == 1) {
+         T.enableFilter(10);
+      }
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      int found = 0;
+      for (const NodeData& nd : queries) {
+         NodeData* p;
+         found += (T.retrieve(nd, p) ? 1 : 0);
+      }
+      cout << (pass == 0 ? "misses, no filter: " : "misses, filter:    ")
+           << elapsedMs(start) << " ms (" << found << " found)" << endl;
+   }
+   BinTree::Stats stats = T.getStats();
+   cout << "filter false-positive rate: " << stats.filterFalsePositiveRate
+        << " (expected " << stats.filterExpectedRate << ")" << endl;
+
+   // The filter grows while insertBatch runs, every key it adds must still
+   // be found afterwards
+   BinTree B;
+   B.enableFilter(10);
+   vector<NodeData*> added = makeData(keys);
+   vector<bool> inserted;
+   B.insertBatch(added.data(), static_cast<int>(added.size()), inserted);
+   int lost = 0;
+   for (size_t i = 0; i < added.size(); i++) {
+      NodeData* p;
+      if (inserted[i]) {
+         lost += (B.retrieve(NodeData(keys[i]), p) ? 0 : 1);
+      }
+      else {
+         delete added[i];                  // duplicate case, not inserted
+      }
+   }
+   if (lost > 0) {
+      cout << "filter: " << lost << " batch-inserted keys not found" << endl;
+   }
+}
+
+//----------------------------------------------------------------------------
+// benchSortedStream
+// sorted keys through insert, hinted insert, insert with rebalancing and a
+// Builder
+
+void benchSortedStream(const vector<string>& keys) {
+   vector<string> sorted(keys);
+   sort(sorted.begin(), sorted.end());
+   sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+   if (sorted.size() > static_cast<size_t>(SORTED_INSERT_KEYS)) {
+      sorted.resize(SORTED_INSERT_KEYS);
+   }
+
+   for (int method = 0; method < 4; method++) {
+      BinTree T;
+      vector<NodeData*> batch = makeData(sorted);
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      if (method == 0) {
+         for (NodeData* ptr : batch) {
+            T.insert(ptr);
+         }
+      }
+      else if (method == 1) {
+         BinTree::Finger finger;
+         for (NodeData* ptr : batch) {
+            T.insert(finger, ptr);
+         }
+      }
+      else if (method == 2) {
+         T.setRebalancing(0.7);
+         for (NodeData* ptr : batch) {
+            T.insert(ptr);
+         }
+      }
+      else {
+         BinTree::Builder builder(T);
+         for (NodeData* ptr : batch) {
+            builder.add(ptr);
+         }
+      }
+      double ms = elapsedMs(start);
+      const char* name[] = { "sorted, insert:    ", "sorted, hinted:    ",
+                             "sorted, alpha 0.7: ", "sorted, Builder:   " };
+      cout << name[method] << ms << " ms (" << sorted.size()
+           << " keys, height " << T.getHeight() << ")" << endl;
+   }
+}
+
+//----------------------------------------------------------------------------
+// makeZipfTrace
+// indexes into a key set of the given size, rank r drawn with weight 1/r^s;
+// ranks are shuffled over the key set so hot keys sit anywhere in the tree
+
+vector<int> makeZipfTrace(int keyCount, int length, double skew,
+                          unsigned seed) {
+   mt19937 gen(seed);
+   vector<double> cdf(keyCount);
+   double total = 0.0;
+   for (int r = 0; r < keyCount; r++) {
+      total += 1.0 / pow(r + 1.0, skew);
+      cdf[r] = total;
+   }
+   vector<int> rankToKey(keyCount);
+   for (int i = 0; i < keyCount; i++) {
+      rankToKey[i] = i;
+   }
+   shuffle(rankToKey.begin(), rankToKey.end(), gen);
+
+   uniform_real_distribution<double> pick(0.0, total);
+   vector<int> trace(length);
+   for (int& t : trace) {
+      int rank = static_cast<int>(lower_bound(cdf.begin(), cdf.end(),
+                                              pick(gen)) - cdf.begin());
+      t = rankToKey[min(rank, keyCount - 1)];
+   }
+   return trace;
+}
+
+//----------------------------------------------------------------------------
+// benchSplay
+// Zipfian retrieves on a balanced tree, plain and in splaying mode
+
+void benchSplay(const vector<string>& keys) {
+   vector<string> distinct(keys);
+   sort(distinct.begin(), distinct.end());
+   distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+   int count = static_cast<int>(distinct.size());
+   vector<int> trace = makeZipfTrace(count, 4 * count, ZIPF_SKEW, 1999);
+   vector<NodeData> queries;
+   queries.reserve(trace.size());
+   for (int t : trace) {
+      queries.push_back(NodeData(distinct[t]));
+   }
+
+   for (int pass = 0; pass < 2; pass++) {
+      BinTree T;
+      vector<NodeData*> batch = makeData(distinct);
+      T.bulkLoad(batch.data(), count);
+      T.setSplaying(pass == 1);
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      int found = 0;
+      for (const NodeData& nd : queries) {
+         NodeData* p;
+         found += (T.retrieve(nd, p) ? 1 : 0);
+      }
+      cout << (pass == 0 ? "zipf, plain:       " : "zipf, splaying:    ")
+           << elapsedMs(start) << " ms (" << found << " found)" << endl;
+   }
+}
+
+//----------------------------------------------------------------------------
+// benchFrozen
+// the same queries, half of them misses, against the tree, a sorted array
+// index, an Eytzinger index, a k-ary index and a van Emde Boas copy
+
+void benchFrozen(const vector<string>& keys) {
+   BinTree T;
+   vector<NodeData*> batch = makeData(keys);
+   T.bulkLoad(batch.data(), static_cast<int>(batch.size()));
+   FrozenIndex sorted(T);
+   EytzingerIndex eytzinger(T);
+   KaryIndex kary(T);
+   VebIndex veb(T);
+
+   vector<string> misses = makeKeys(static_cast<int>(keys.size()), 4242);
+   vector<NodeData> queries;
+   queries.reserve(2 * keys.size());
+   for (size_t i = 0; i < keys.size(); i++) {
+      queries.push_back(NodeData(keys[i]));
+      queries.push_back(NodeData(misses[i]));
+   }
+   shuffle(queries.begin(), queries.end(), mt19937(77));
+
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   int found = 0;
+   for (const NodeData& nd : queries) {
+      NodeData* p;
+      found += (T.retrieve(nd, p) ? 1 : 0);
+   }
+   cout << "tree retrieve:     " << elapsedMs(start) << " ms (" << found
+        << " found)" << endl;
+
+   start = chrono::steady_clock::now();
+   found = 0;
+   for (const NodeData& nd : queries) {
+      const NodeData* p;
+      found += (sorted.retrieve(nd, p) ? 1 : 0);
+   }
+   cout << "sorted array:      " << elapsedMs(start) << " ms (" << found
+        << " found)" << endl;
+
+   start = chrono::steady_clock::now();
+   found = 0;
+   for (const NodeData& nd : queries) {
+      found += (eytzinger.retrieve(nd) ? 1 : 0);
+   }
+   cout << "eytzinger:         " << elapsedMs(start) << " ms (" << found
+        << " found)" << endl;
+
+   start = chrono::steady_clock::now();
+   found = 0;
+   for (const NodeData& nd : queries) {
+      const NodeData* p;
+      found += (kary.retrieve(nd, p) ? 1 : 0);
+   }
+   cout << "k-ary (16 keys):   " << elapsedMs(start) << " ms (" << found
+        << " found)" << endl;
+
+   start = chrono::steady_clock::now();
+   found = 0;
+   for (const NodeData& nd : queries) {
+      const NodeData* p;
+      found += (veb.retrieve(nd, p) ? 1 : 0);
+   }
+   cout << "van Emde Boas:     " << elapsedMs(start) << " ms (" << found
+        << " found)" << endl;
+}
+
+//----------------------------------------------------------------------------
+// benchBTree
+// the buildTree insert loop and one retrieve per key through both engines
+
+void benchBTree(const vector<string>& keys) {
+   vector<NodeData> queries(keys.begin(), keys.end());
+   shuffle(queries.begin(), queries.end(), mt19937(5));
+
+   BinTree T;
+   vector<NodeData*> batch = makeData(keys);
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   for (NodeData* ptr : batch) {
+      if (!T.insert(ptr)) {
+         delete ptr;                       // duplicate case, not inserted
+      }
+   }
+   double insertMs = elapsedMs(start);
+   start = chrono::steady_clock::now();
+   int found = 0;
+   for (const NodeData& nd : queries) {
+      NodeData* p;
+      found += (T.retrieve(nd, p) ? 1 : 0);
+   }
+   cout << "BinTree:           insert " << insertMs << " ms, retrieve "
+        << elapsedMs(start) << " ms (height " << T.getHeight() << ")" << endl;
+
+   BTree B;
+   batch = makeData(keys);
+   start = chrono::steady_clock::now();
+   for (NodeData* ptr : batch) {
+      if (!B.insert(ptr)) {
+         delete ptr;                       // duplicate case, not inserted
+      }
+   }
+   insertMs = elapsedMs(start);
+   start = chrono::steady_clock::now();
+   found = 0;
+   for (const NodeData& nd : queries) {
+      NodeData* p;
+      found += (B.retrieve(nd, p) ? 1 : 0);
+   }
+   cout << "BTree:             insert " << insertMs << " ms, retrieve "
+        << elapsedMs(start) << " ms (height " << B.getHeight() << ")" << endl;
+}
+
+//----------------------------------------------------------------------------
+// benchPaged
+// inserts and retrieves through a disk-backed tree with a small and a large
+// buffer pool, reporting the pool's hit rate
+
+void benchPaged(const vector<string>& keys) {
+   vector<NodeData> queries(keys.begin(), keys.end());
+   shuffle(queries.begin(), queries.end(), mt19937(6));
+   const int poolPages[] = { 64, 16384 };    // 256 KB and 64 MB of pages
+
+   for (int pages : poolPages) {
+      PagedTree P;
+      if (!P.create(PAGE_FILE, pages)) {
+         cout << "paged tree: could not create " << PAGE_FILE << endl;
+         return;
+      }
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      for (const string& s : keys) {
+         P.insert(NodeData(s));
+      }
+      double insertMs = elapsedMs(start);
+      double insertHits = P.getStats().hitRate;
+      P.resetStats();
+      start = chrono::steady_clock::now();
+      int found = 0;
+      for (const NodeData& nd : queries) {
+         NodeData copy;
+         found += (P.retrieve(nd, copy) ? 1 : 0);
+      }
+      double retrieveMs = elapsedMs(start);
+      BufferPool::Stats stats = P.getStats();
+      cout << "paged, " << pages << " pages: insert " << insertMs
+           << " ms (hit rate " << insertHits << "), retrieve " << retrieveMs
+           << " ms (hit rate " << stats.hitRate << ", " << stats.reads
+           << " reads)" << endl;
+   }
+   remove(PAGE_FILE);
+}
+
+//----------------------------------------------------------------------------
+// benchRadix
+// the buildTree insert loop and one retrieve per key through BinTree and the
+// radix tree, on the random tokens and on path-like keys that share a long
+// leading part, where each BinTree comparison rescans that part
+
+void benchRadix(const vector<string>& keys) {
+   vector<string> paths;
+   paths.reserve(keys.size());
+   for (const string& s : keys) {
+      paths.push_back("/usr/share/doc/packages/" + s + "/README");
+   }
+   const vector<string>* keySets[] = { &keys, &paths };
+   const char* names[] = { "tokens", "paths" };
+
+   for (int k = 0; k < 2; k++) {
+      vector<NodeData> queries(keySets[k]->begin(), keySets[k]->end());
+      shuffle(queries.begin(), queries.end(), mt19937(7));
+
+      BinTree T;
+      vector<NodeData*> batch = makeData(*keySets[k]);
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      for (NodeData* ptr : batch) {
+         if (!T.insert(ptr)) {
+            delete ptr;                    // duplicate case, not inserted
+         }
+      }
+      double insertMs = elapsedMs(start);
+      start = chrono::steady_clock::now();
+      int found = 0;
+      for (const NodeData& nd : queries) {
+         NodeData* p;
+         found += (T.retrieve(nd, p) ? 1 : 0);
+      }
+      string label = string("BinTree, ") + names[k] + ":";
+      cout << label << string(19 - label.size(), ' ') << "insert " << insertMs
+           << " ms, retrieve " << elapsedMs(start) << " ms" << endl;
+
+      RadixTree R;
+      batch = makeData(*keySets[k]);
+      start = chrono::steady_clock::now();
+      for (NodeData* ptr : batch) {
+         if (!R.insert(ptr)) {
+            delete ptr;                    // duplicate case, not inserted
+         }
+      }
+      insertMs = elapsedMs(start);
+      start = chrono::steady_clock::now();
+      found = 0;
+      for (const NodeData& nd : queries) {
+         NodeData* p;
+         found += (R.retrieve(nd, p) ? 1 : 0);
+      }
+      label = string("RadixTree, ") + names[k] + ":";
+      cout << label << string(19 - label.size(), ' ') << "insert " << insertMs
+           << " ms, retrieve " << elapsedMs(start) << " ms" << endl;
+   }
+}
+
+//----------------------------------------------------------------------------
+// benchKeywords
+// every token checked against lab2's fixed keys, held in a BinTree built at
+// run time and in the compile-time KeywordSet
+
+void benchKeywords(const vector<string>& keys) {
+   vector<NodeData> queries(keys.begin(), keys.end());
+   for (int i = 0; i < LAB2_SET.getSize(); i++) {
+      queries[i * queries.size() / LAB2_SET.getSize()] =
+         NodeData(LAB2_SET.getKey(i));     // make sure some probes hit
+   }
+
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   BinTree T;
+   for (const char* key : LAB2_KEYS) {
+      T.insert(new NodeData(key));
+   }
+   int found = 0;
+   for (const NodeData& nd : queries) {
+      NodeData* p;
+      found += (T.retrieve(nd, p) ? 1 : 0);
+   }
+   cout << "keywords, BinTree:   " << elapsedMs(start) << " ms (" << found
+        << " found)" << endl;
+
+   start = chrono::steady_clock::now();
+   found = 0;
+   for (const NodeData& nd : queries) {
+      found += (LAB2_SET.contains(nd) ? 1 : 0);
+   }
+   cout << "keywords, constexpr: " << elapsedMs(start) << " ms (" << found
+        << " found)" << endl;
+}
+
+//----------------------------------------------------------------------------
+// writeTokenFile
+// writes the keys as a data file of "$$" terminated lines
+
+void writeTokenFile(const vector<string>& keys) {
+   ofstream out(TOKEN_FILE);
+   for (size_t i = 0; i < keys.size(); i++) {
+      out << keys[i] << ((i + 1) % TOKENS_PER_LINE == 0 ? " $$\n" : " ");
+   }
+   out << "$$" << endl;
+}
+
+//----------------------------------------------------------------------------
+// benchLoad
+// scans the token file and builds one tree per line with buildTree's >> loop
+// and with the mapped TreeLoader
+
+void benchLoad(const vector<string>& keys) {
+   writeTokenFile(keys);
+
+   // Scanning alone, to separate tokenizing from building the trees
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   ifstream scan(TOKEN_FILE);
+   long long bytes = 0;
+   string s;
+   while (scan >> s) {
+      bytes += static_cast<long long>(s.size());
+   }
+   cout << "scan, >>:           " << elapsedMs(start) << " ms (" << bytes
+        << " bytes)" << endl;
+   // Mapped scans with the scalar scanner and with the fastest one
+   string best = TokenScanner::getMode();
+   const string modes[] = { "scalar", best };
+   for (const string& mode : modes) {
+      TokenScanner::setMode(mode);
+      start = chrono::steady_clock::now();
+      TreeLoader scanner;
+      scanner.open(TOKEN_FILE);
+      bytes = 0;
+      const char* token;
+      size_t length;
+      while (scanner.nextToken(token, length)) {
+         bytes += static_cast<long long>(length);
+      }
+      string label = "scan, mapped " + mode + ":";
+      cout << label << string(max<int>(20 - label.size(), 1), ' ')
+           << elapsedMs(start) << " ms (" << bytes << " bytes)" << endl;
+   }
+
+   start = chrono::steady_clock::now();
+   ifstream infile(TOKEN_FILE);
+   int trees = 0;
+   long long added = 0;
+   while (infile >> s) {                   // buildTree's loop without echo
+      BinTree T;
+      while (s != "$$") {
+         NodeData* ptr = new NodeData(s);
+         if (T.insert(ptr)) {
+            added++;
+         }
+         else {
+            delete ptr;                    // duplicate case, not inserted
+         }
+         if (!(infile >> s)) {
+            break;
+         }
+      }
+      trees++;
+   }
+   cout << "load, >>:           " << elapsedMs(start) << " ms (" << trees
+        << " trees, " << added << " objects)" << endl;
+
+   for (int balanced = 0; balanced < 2; balanced++) {
+      start = chrono::steady_clock::now();
+      TreeLoader loader;
+      if (!loader.open(TOKEN_FILE)) {
+         cout << "loader: could not open " << TOKEN_FILE << endl;
+         return;
+      }
+      trees = 0;
+      added = 0;
+      while (!loader.atEnd()) {
+         BinTree T;
+         added += loader.loadRecord(T, balanced == 1);
+         trees++;
+      }
+      cout << (balanced == 0 ? "load, mapped:       " : "load, mapped batch: ")
+           << elapsedMs(start) << " ms (" << trees << " trees, " << added
+           << " objects)" << endl;
+   }
+   remove(TOKEN_FILE);
+}
+
+//----------------------------------------------------------------------------
+// benchIngest
+// builds every line's tree of the token file and probes it for lab2's keys,
+// on one worker thread and on one per core; both must print the same
+
+void benchIngest(const vector<string>& keys) {
+   writeTokenFile(keys);
+   auto job = [](BinTree& T, ostream& out) {
+      NodeData* found;
+      for (const char* key : LAB2_KEYS) {
+         out << (T.retrieve(NodeData(key), found) ? '+' : '-');
+      }
+      out << ' ' << T.getHeight() << '\n';
+   };
+   int cores = static_cast<int>(thread::hardware_concurrency());
+   const int workers[] = { 1, (cores > 0 ? cores : 1) };
+   string first;
+   for (int w : workers) {
+      IngestDriver driver;
+      if (!driver.open(TOKEN_FILE)) {
+         cout << "ingest: could not open " << TOKEN_FILE << endl;
+         return;
+      }
+      ostringstream out;
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      int trees = driver.run(job, out, w);
+      string label = "ingest, " + to_string(w) + " threads:";
+      cout << label << string(max<int>(20 - label.size(), 1), ' ')
+           << elapsedMs(start) << " ms (" << trees << " trees, "
+           << driver.getObjects() << " objects)" << endl;
+      if (first.empty()) {
+         first = out.str();
+      }
+      else if (out.str() != first) {
+         cout << "ingest: output differs from one thread" << endl;
+      }
+   }
+   remove(TOKEN_FILE);
+}
+
+//----------------------------------------------------------------------------
+// benchSnapshot
+// one tree of all the keys in file order, rebuilt from text with buildTree's
+// >> loop and reloaded from a binary snapshot; both must have the same shape
+
+void benchSnapshot(const vector<string>& keys) {
+   ofstream text(TOKEN_FILE);
+   for (const string& key : keys) {
+      text << key << ' ';
+   }
+   text << "$$" << endl;
+   text.close();
+
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   ifstream infile(TOKEN_FILE);
+   BinTree T;
+   string s;
+   while (infile >> s && s != "$$") {
+      NodeData* ptr = new NodeData(s);
+      if (!T.insert(ptr)) {
+         delete ptr;                       // duplicate case, not inserted
+      }
+   }
+   cout << "rebuild, text:      " << elapsedMs(start) << " ms" << endl;
+
+   ofstream out(SNAPSHOT_FILE, ios::binary);
+   start = chrono::steady_clock::now();
+   T.save(out);
+   out.close();
+   cout << "snapshot, save:     " << elapsedMs(start) << " ms" << endl;
+
+   start = chrono::steady_clock::now();
+   ifstream in(SNAPSHOT_FILE, ios::binary);
+   BinTree L;
+   bool loaded = L.load(in);
+   cout << "snapshot, load:     " << elapsedMs(start) << " ms" << endl;
+   if (!loaded || L != T) {
+      cout << "snapshot: loaded tree differs" << endl;
+   }
+   remove(TOKEN_FILE);
+   remove(SNAPSHOT_FILE);
+}
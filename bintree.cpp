@@ -9,14 +9,130 @@
 //      --allows the retrieval of parent nodes
 //      --allows the outputting of a Binary Tree to an Array
 //      --allows the building of a Binary Tree from a sorted Array
+//      --allows bulk loading a balanced Binary Tree from an unsorted Array
+//      --allows merging a batch of NodeData objects into an existing tree
+//      --allows retrieving a batch of NodeData objects with interleaved
+//        searches
+//      --allows an optional Bloom filter to answer retrieve misses early
+//      --allows an optional cache of recently retrieved nodes
+//      --allows an optional hash index that answers point lookups without a
+//        descent
+//      --allows hinted inserts that resume from the last insertion path
+//      --allows building a balanced Binary Tree from a sorted stream
+//      --allows automatic partial rebuilds that keep the height logarithmic
+//      --allows a self-adjusting (splay) mode for skewed lookups
+//      --allows removing single objects or a range of objects
+//      --allows splitting a tree at a key and joining two trees
+//      --allows union, intersection and difference of two trees
+//      --allows copying the objects out in sorted order without emptying
+//        the tree
+//      --allows visiting the objects that start with a prefix, in order
+//      --allows saving a binary snapshot and loading it back with the same
+//        shape
 //
 // Assumptions:
 //      --user will pass pointers to NodeData objects to add nodes to the tree
 //      --array passed to arrayToBSTree() is already sorted beforehand
 //      --for <<, tree outputs data in each node followed by a space
+//      --a snapshot lists the objects in order with their depths, which
+//        together fix the shape
 //----------------------------------------------------------------------------
 
 #include "bintree.h"
+#include "prefetch.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// batches smaller than this are sorted on the calling thread only
+const int PARALLEL_SORT_CUTOFF = 1 << 14;
+
+// batch runs shorter than this always descend instead of trying a rebuild
+const int BATCH_REBUILD_CUTOFF = 8;
+
+// number of searches retrieveBatch advances in lock-step
+const int RETRIEVE_GROUP = 16;
+
+// merged keys needed before a set operation merges key ranges in parallel
+const int PARALLEL_MERGE_CUTOFF = 1 << 15;
+
+// which nodes a set operation keeps: only in the 1st tree, in both, only in
+// the 2nd
+const int KEEP_FIRST = 1;
+const int KEEP_BOTH = 2;
+const int KEEP_SECOND = 4;
+
+// fewest keys a Bloom filter is sized for
+const int MIN_FILTER_KEYS = 64;
+
+// fewest slots the hash index has, always a power of 2
+const size_t MIN_INDEX_SLOTS = 16;
+
+// snapshot header: magic "BTRE", version, objects, payload bytes, checksum
+const uint32_t SNAPSHOT_MAGIC = 0x42545245;
+const uint32_t SNAPSHOT_VERSION = 1;
+const size_t SNAPSHOT_HEADER_BYTES = 4 + 4 + 8 + 8 + 8;
+
+// most payload bytes load reads at a time, so a damaged size can't make it
+// allocate more than the stream holds
+const size_t SNAPSHOT_READ_BYTES = 1 << 20;
+
+// copies a value into a buffer at the offset and advances it
+template <typename T>
+static void putValue(char* buffer, size_t& offset, T value) {
+    memcpy(buffer + offset, &value, sizeof(T));
+    offset += sizeof(T);
+}
+
+// reads a value from a buffer at the offset and advances it
+template <typename T>
+static T getValue(const char* buffer, size_t& offset) {
+    T value;
+    memcpy(&value, buffer + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+// appends a value 7 bits per byte, low bits first, high bit set on all but
+// the last byte
+static void putVarint(string& out, uint64_t value) {
+    while(value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// reads a value written by putVarint, false if it runs past the end
+static bool getVarint(const char*& pos, const char* end, uint64_t& value) {
+    value = 0;
+    for(int shift = 0; pos < end && shift < 64; shift += 7) {
+        unsigned char byte = static_cast<unsigned char>(*pos++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 64-bit FNV-1a of a byte range, the snapshot checksum
+static uint64_t checksum(const char* bytes, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < size; i++) {
+        h ^= static_cast<unsigned char>(bytes[i]);
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// orders NodeData pointers by the objects they point to
+static bool dataLess(const NodeData* lhs, const NodeData* rhs) {
+    return *lhs < *rhs;
+}
 
 //----------------------------------------------------------------------------
 // operator<<
@@ -51,6 +167,19 @@ void BinTree::inorderHelper(Node* curPtr, ostream& os) const {
 BinTree::BinTree() {
     // Make an empty tree
     root = nullptr;
+    filterRejects = 0;
+    filterFalsePositives = 0;
+    cacheHits = 0;
+    cacheMisses = 0;
+    indexedNodes = 0;
+    structureVersion = 0;
+    insertVersion = 0;
+    nodeCount = 0;
+    maxNodeCount = 0;
+    balanceAlpha = 0.0;
+    splaying = false;
+    rebuilds = 0;
+    rebuiltNodes = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -60,6 +189,27 @@ BinTree::BinTree() {
 BinTree::BinTree(const BinTree & otherTree) {
     // Call helper function passing the roots of both trees
     copyHelper(this->root, otherTree.root);
+    // Same keys, so the filter bits carry over as they are
+    filter = otherTree.filter;
+    filterRejects = 0;
+    filterFalsePositives = 0;
+    // Cached nodes belong to the other tree, only take its size
+    cache.assign(otherTree.cache.size(), CacheSlot());
+    cacheHits = 0;
+    cacheMisses = 0;
+    structureVersion = 0;
+    insertVersion = 0;
+    nodeCount = otherTree.nodeCount;
+    maxNodeCount = otherTree.maxNodeCount;
+    balanceAlpha = otherTree.balanceAlpha;
+    splaying = otherTree.splaying;
+    rebuilds = 0;
+    rebuiltNodes = 0;
+    // Indexed nodes belong to the other tree, index this tree's own
+    indexedNodes = 0;
+    if(!otherTree.hashIndex.empty()) {
+        enableHashIndex();
+    }
 }
 
 void BinTree::copyHelper(Node*& newTreeNode, const Node* oldTreeNode) {
@@ -103,6 +253,7 @@ bool BinTree::isEmpty() const {
 void BinTree::makeEmpty() {
     // Call helper function on root
     makeEmptyHelper(root);
+    recordClear();
 } 
 
 void BinTree::makeEmptyHelper(Node*& treeNode) {
@@ -137,6 +288,18 @@ BinTree& BinTree::operator=(const BinTree& otherTree) {
     makeEmpty();
     // Call helper function on the roots
     copyHelper(this->root, otherTree.root); 
+    filter = otherTree.filter;
+    cache.assign(otherTree.cache.size(), CacheSlot());
+    nodeCount = otherTree.nodeCount;
+    maxNodeCount = otherTree.maxNodeCount;
+    balanceAlpha = otherTree.balanceAlpha;
+    splaying = otherTree.splaying;
+    if(!otherTree.hashIndex.empty()) {
+        enableHashIndex();
+    }
+    else {
+        disableHashIndex();
+    }
     return *this;
 }
 
@@ -200,17 +363,22 @@ bool BinTree::insert(NodeData* dataptr) {
     ptr->data = dataptr;
     dataptr = nullptr;
     ptr->left = ptr->right = nullptr;
+    if (splaying) {
+        return splayInsert(ptr);
+    }
     if (isEmpty()) {
         root = ptr;
     }
     else {
         Node* current = root;
         bool inserted = false;
+        int depth = 0;                         // edges from root to new node
 
         // if item is less than current item, insert in left subtree,
         // if item is greater than current item, insert in right subtree
         // if item is equal to current item, do not insert
         while (!inserted) {
+            depth++;
             if (*ptr->data < *current->data) {
                 if (current->left == nullptr) {         // at leaf, insert left
                     current->left = ptr;
@@ -233,10 +401,484 @@ bool BinTree::insert(NodeData* dataptr) {
                 return false;
             }
         }
+        recordInsert(ptr);
+        rebalanceAfterInsert(*ptr->data, depth);
+        return true;
+    }
+    recordInsert(ptr);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// insert (hinted)
+// Preconditions: NodeData to add is of same type and comparable to those in
+//                the tree; the Finger was last used with this tree or is new
+// Postconditions: Same as insert, but the search starts from the deepest node
+//                 on the Finger's path whose subtree must hold the new object,
+//                 so adjacent keys cost only the distance between them. The
+//                 Finger is updated to the new path
+bool BinTree::insert(Finger& hint, NodeData* dataptr) {
+    // Every splay relinks the path, a finger would never be valid
+    if(splaying) {
+        return insert(dataptr);
+    }
+    // Path from another tree, or from before nodes were relinked, is useless
+    if(hint.owner != this || hint.version != structureVersion) {
+        hint.path.clear();
+        hint.owner = this;
+        hint.version = structureVersion;
+    }
+    // Back up to the deepest node whose key range holds the new object
+    while(!hint.path.empty()) {
+        const Finger::Step& step = hint.path.back();
+        if((step.low == nullptr || *step.low < *dataptr) &&
+        (step.high == nullptr || *dataptr < *step.high)) {
+            break;
+        }
+        hint.path.pop_back();
+    }
+    Node* ptr = new Node;
+    ptr->data = dataptr;
+    ptr->left = ptr->right = nullptr;
+    if(hint.path.empty()) {
+        if(isEmpty()) {
+            root = ptr;
+            hint.path.push_back({ptr, nullptr, nullptr});
+            recordInsert(ptr);
+            return true;
+        }
+        hint.path.push_back({root, nullptr, nullptr});
+    }
+    // Descend from there as insert does, extending the path on the way
+    for(;;) {
+        Finger::Step step = hint.path.back();
+        Node* current = step.node;
+        if(*dataptr < *current->data) {
+            if(current->left == nullptr) {             // at leaf, insert left
+                current->left = ptr;
+            }
+            hint.path.push_back({current->left, step.low, current->data});
+        }
+        else if(*dataptr > *current->data) {
+            if(current->right == nullptr) {            // at leaf, insert right
+                current->right = ptr;
+            }
+            hint.path.push_back({current->right, current->data, step.high});
+        }
+        else {
+            delete ptr;                                // duplicate
+            return false;
+        }
+        if(hint.path.back().node == ptr) {
+            break;
+        }
+    }
+    recordInsert(ptr);
+    int depth = static_cast<int>(hint.path.size()) - 1;
+    if(tooDeep(depth)) {
+        vector<Node*> path;
+        for(const Finger::Step& step : hint.path) {
+            path.push_back(step.node);
+        }
+        // Nodes above the scapegoat kept their places and key ranges
+        int scapegoat = rebuildScapegoat(path);
+        hint.path.resize(scapegoat);
+        hint.version = structureVersion;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// remove
+// Preconditions: second NodeData argument is expected to be used to take
+//                ownership of the removed NodeData
+// Postconditions: returns true if the 1st argument is found, its node is
+//                 unlinked and deleted and the 2nd argument is set to the
+//                 NodeData it held, which the caller now owns. The active
+//                 balancing policy is kept. Otherwise returns false and the
+//                 tree is unchanged
+bool BinTree::remove(const NodeData& toFind, NodeData*& toReturn) {
+    // Tree is empty, nothing to remove here
+    if(isEmpty()) {
+        return false;
+    }
+    Node* node = nullptr;
+    if(splaying) {
+        // Splay it to the root, then join the two subtrees left behind
+        root = splayHelper(root, toFind);
+        structureVersion++;
+        if(*root->data != toFind) {
+            return false;
+        }
+        node = root;
+        if(node->left == nullptr) {
+            root = node->right;
+        }
+        else {
+            // Every key on the left is smaller, so the largest comes up
+            root = splayHelper(node->left, toFind);
+            root->right = node->right;
+        }
     }
+    else {
+        // Find the link that points at the node
+        Node** link = &root;
+        while(*link != nullptr && *(*link)->data != toFind) {
+            link = (toFind < *(*link)->data ? &(*link)->left :
+                &(*link)->right);
+        }
+        if(*link == nullptr) {
+            return false;
+        }
+        node = *link;
+        *link = joinHelper(node->left, node->right);
+        structureVersion++;
+    }
+    toReturn = node->data;
+    recordRemove(node);
+    delete node;
+    afterRemove();
     return true;
 }
 
+//----------------------------------------------------------------------------
+// removeRange
+// Preconditions: first NodeData argument is not greater than the second
+// Postconditions: Every object from the 1st argument to the 2nd (both
+//                 included) is unlinked and its NodeData appended in order to
+//                 the vector, which the caller now owns. The range is cut
+//                 out along two search paths and the rest joined once, so it
+//                 takes O(height + k) for k removed objects, O(log n + k) on
+//                 a balanced tree. Returns k
+int BinTree::removeRange(const NodeData& low, const NodeData& high,
+vector<NodeData*>& removed) {
+    if(isEmpty() || high < low) {
+        return 0;
+    }
+    // Cut out the range along two search paths, then close the gap with a
+    // single join of what is left on either side
+    Node* less;
+    Node* rest;
+    Node* inRange;
+    Node* more;
+    splitNodes(root, low, false, less, rest);
+    splitNodes(rest, high, true, inRange, more);
+    vector<Node*> nodes;
+    flattenHelper(inRange, nodes);
+    for(Node* node : nodes) {
+        removed.push_back(node->data);
+        recordRemove(node);
+        delete node;
+    }
+    root = joinHelper(less, more);
+    // Nodes along both paths were relinked even if none was removed
+    structureVersion++;
+    int count = static_cast<int>(nodes.size());
+    if(count > 0) {
+        afterRemove();
+    }
+    return count;
+}
+
+void BinTree::splitNodes(Node* source, const NodeData& key, bool inclusive,
+Node*& less, Node*& more) {
+    // Walk one search path, hanging nodes off whichever side they belong to
+    less = nullptr;
+    more = nullptr;
+    Node** lessLink = &less;
+    Node** moreLink = &more;
+    while(source != nullptr) {
+        if(*source->data < key || (inclusive && *source->data == key)) {
+            *lessLink = source;
+            lessLink = &source->right;
+            source = source->right;
+        }
+        else {
+            *moreLink = source;
+            moreLink = &source->left;
+            source = source->left;
+        }
+    }
+    *lessLink = nullptr;
+    *moreLink = nullptr;
+}
+
+BinTree::Node* BinTree::joinHelper(Node* left, Node* right) {
+    if(left == nullptr) {
+        return right;
+    }
+    if(right == nullptr) {
+        return left;
+    }
+    // Largest node on the left becomes the root of both, its own left
+    // subtree takes its old place
+    Node* parent = nullptr;
+    Node* largest = left;
+    while(largest->right != nullptr) {
+        parent = largest;
+        largest = largest->right;
+    }
+    if(parent != nullptr) {
+        parent->right = largest->left;
+        largest->left = left;
+    }
+    largest->right = right;
+    return largest;
+}
+
+//----------------------------------------------------------------------------
+// split
+// Preconditions: The two tree arguments are different trees
+// Postconditions: Objects less than the NodeData argument are moved into the
+//                 1st tree argument and the rest into the 2nd, by relinking
+//                 the nodes along one search path in O(height); no NodeData is
+//                 copied. Both trees' old contents are deleted first, both
+//                 take this tree's settings, and this tree is left empty.
+//                 With a Bloom filter on, each half rebuilds its filter from
+//                 its own objects, which takes O(n).
+//                 Either tree argument may be this tree. If both arguments
+//                 are the same tree nothing is changed
+void BinTree::split(const NodeData& key, BinTree& left, BinTree& right) {
+    // One tree can't hold both halves, and taking the second would leak the
+    // first
+    if(&left == &right) {
+        return;
+    }
+    // Take everything needed from this tree first, it may be an argument
+    Node* source = root;
+    root = nullptr;
+    BinTree settings;
+    // Only the filter's bits per key carry over, each half fills its own
+    if(filter.isEnabled()) {
+        settings.filter = BloomFilter(MIN_FILTER_KEYS,
+            filter.getBitsPerKey());
+    }
+    settings.cache.assign(cache.size(), CacheSlot());
+    settings.hashIndex.assign(hashIndex.size(), IndexSlot());
+    settings.balanceAlpha = balanceAlpha;
+    settings.splaying = splaying;
+    settings.maxNodeCount = max(maxNodeCount, nodeCount);
+    makeEmpty();
+    left.makeEmpty();
+    right.makeEmpty();
+    Node* less;
+    Node* more;
+    splitNodes(source, key, false, less, more);
+    left.takeNodes(less, settings);
+    right.takeNodes(more, settings);
+}
+
+//----------------------------------------------------------------------------
+// join
+// Preconditions: every object in the 1st tree argument is less than every
+//                object in the 2nd
+// Postconditions: This tree's old contents are deleted and it takes the nodes
+//                 of both arguments by relinking in O(height of the 1st); no
+//                 NodeData is copied. Both arguments are left empty, unless
+//                 one of them is this tree. Settings of this tree are kept; a
+//                 Bloom filter is merged when both sides' filters match, else
+//                 rebuilt
+void BinTree::join(BinTree& left, BinTree& right) {
+    // Take both sides first, this tree may be one of them
+    Node* leftRoot = left.root;
+    Node* rightRoot = right.root;
+    left.root = nullptr;
+    right.root = nullptr;
+    bool counted = (left.nodeCount >= 0 && right.nodeCount >= 0);
+    int count = left.nodeCount + right.nodeCount;
+    // Halves of one split both carry the whole tree's peak, so adding the
+    // peaks would double it on every split and join; the larger one is
+    // still an upper bound for them
+    int maxCount = (counted ? count : max(max(left.maxNodeCount,
+        left.nodeCount), max(right.maxNodeCount, right.nodeCount)));
+    BloomFilter merged = left.filter;
+    bool mergedOk = left.filter.isEnabled() && merged.merge(right.filter);
+    left.makeEmpty();
+    right.makeEmpty();
+    makeEmpty();
+    // Largest key on the left becomes the root over both sides
+    root = joinHelper(leftRoot, rightRoot);
+    nodeCount = (counted ? count : -1);
+    maxNodeCount = maxCount;
+    if(filter.isEnabled()) {
+        if(mergedOk && merged.getBitsPerKey() == filter.getBitsPerKey()) {
+            filter = merged;
+        }
+        else {
+            rebuildFilter();
+        }
+    }
+    rebuildIndex();
+}
+
+void BinTree::takeNodes(Node* subtree, const BinTree& settings) {
+    root = subtree;
+    cache.assign(settings.cache.size(), CacheSlot());
+    balanceAlpha = settings.balanceAlpha;
+    splaying = settings.splaying;
+    // Counting the side would cost O(n), so it is counted when first needed;
+    // the old peak is still an upper bound for the rebalancing rule
+    nodeCount = -1;
+    maxNodeCount = settings.maxNodeCount;
+    // A copy of the whole tree's filter would claim the other half's keys,
+    // so the filter is refilled from the taken nodes alone
+    filter = settings.filter;
+    rebuildFilter();
+    // The taken nodes have to be indexed one by one
+    if(!settings.hashIndex.empty()) {
+        enableHashIndex();
+    }
+    else {
+        disableHashIndex();
+    }
+}
+
+//----------------------------------------------------------------------------
+// setUnion
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it holds every
+//                 object found in either tree argument, perfectly balanced.
+//                 The in-order sequences are merged in O(n + m) (in parallel
+//                 for large trees) and nodes are relinked, not copied; when
+//                 both hold an object the 2nd tree's copy is deleted. Both
+//                 arguments are left empty, unless one of them is this tree
+void BinTree::setUnion(BinTree& first, BinTree& second) {
+    setOperationHelper(first, second, KEEP_FIRST | KEEP_BOTH | KEEP_SECOND);
+}
+
+//----------------------------------------------------------------------------
+// setIntersection
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it holds the 1st
+//                 tree's objects that are also in the 2nd, perfectly balanced,
+//                 in O(n + m); every other object is deleted. Both arguments
+//                 are left empty, unless one of them is this tree
+void BinTree::setIntersection(BinTree& first, BinTree& second) {
+    setOperationHelper(first, second, KEEP_BOTH);
+}
+
+//----------------------------------------------------------------------------
+// setDifference
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it holds the 1st
+//                 tree's objects that are not in the 2nd, perfectly balanced,
+//                 in O(n + m); every other object is deleted. Both arguments
+//                 are left empty, unless one of them is this tree
+void BinTree::setDifference(BinTree& first, BinTree& second) {
+    setOperationHelper(first, second, KEEP_FIRST);
+}
+
+void BinTree::setOperationHelper(BinTree& first, BinTree& second, int keep) {
+    // Take both in-order sequences first, this tree may be one of them
+    vector<Node*> firstNodes;
+    vector<Node*> secondNodes;
+    bool sameTree = (&first == &second);
+    flattenHelper(first.root, firstNodes);
+    if(!sameTree) {
+        flattenHelper(second.root, secondNodes);
+    }
+    first.root = nullptr;
+    second.root = nullptr;
+    first.makeEmpty();
+    second.makeEmpty();
+    makeEmpty();
+    // A tree compared with itself holds every object in both
+    if(sameTree) {
+        keep = ((keep & KEEP_BOTH) != 0 ? KEEP_FIRST : 0);
+    }
+    int firstCount = static_cast<int>(firstNodes.size());
+    int secondCount = static_cast<int>(secondNodes.size());
+    vector<Node*> merged;
+    merged.reserve(firstCount + secondCount);
+    int workers = static_cast<int>(thread::hardware_concurrency());
+    // Small trees (or a single core) aren't worth the thread start-up cost
+    if(workers < 2 || firstCount + secondCount < PARALLEL_MERGE_CUTOFF ||
+    firstCount < workers) {
+        mergeNodesHelper(firstNodes.data(), firstCount, secondNodes.data(),
+            secondCount, keep, merged);
+    }
+    else {
+        // Cut the 1st sequence evenly, the 2nd where the same keys start
+        vector<int> firstBounds(workers + 1);
+        vector<int> secondBounds(workers + 1);
+        for(int i = 0; i <= workers; i++) {
+            firstBounds[i] = static_cast<int>(static_cast<long long>(
+                firstCount) * i / workers);
+        }
+        secondBounds[0] = 0;
+        secondBounds[workers] = secondCount;
+        for(int i = 1; i < workers; i++) {
+            const NodeData* key = firstNodes[firstBounds[i]]->data;
+            secondBounds[i] = static_cast<int>(lower_bound(
+                secondNodes.begin() + secondBounds[i - 1], secondNodes.end(),
+                key, [](const Node* node, const NodeData* value) {
+                    return *node->data < *value;
+                }) - secondNodes.begin());
+        }
+        // Every key range is merged on its own thread, then concatenated
+        vector<vector<Node*> > pieces(workers);
+        vector<thread> pool;
+        for(int i = 0; i < workers; i++) {
+            pool.emplace_back([&, i]() {
+                mergeNodesHelper(firstNodes.data() + firstBounds[i],
+                    firstBounds[i + 1] - firstBounds[i],
+                    secondNodes.data() + secondBounds[i],
+                    secondBounds[i + 1] - secondBounds[i], keep, pieces[i]);
+            });
+        }
+        for(thread& t : pool) {
+            t.join();
+        }
+        for(const vector<Node*>& piece : pieces) {
+            merged.insert(merged.end(), piece.begin(), piece.end());
+        }
+    }
+    // Sorted nodes are relinked straight into a balanced tree
+    root = linkBalancedHelper(merged.data(), 0,
+        static_cast<int>(merged.size()) - 1);
+    nodeCount = maxNodeCount = static_cast<int>(merged.size());
+    rebuildFilter();
+    rebuildIndex();
+}
+
+void BinTree::mergeNodesHelper(Node* first[], int firstCount, Node* second[],
+int secondCount, int keep, vector<Node*>& merged) {
+    int i = 0;
+    int j = 0;
+    while(i < firstCount || j < secondCount) {
+        Node* node;
+        Node* duplicate = nullptr;
+        bool wanted;
+        // Take the smaller key, or both nodes when the keys are equal
+        if(j == secondCount || (i < firstCount && *first[i]->data <
+        *second[j]->data)) {
+            node = first[i++];
+            wanted = ((keep & KEEP_FIRST) != 0);
+        }
+        else if(i == firstCount || *second[j]->data < *first[i]->data) {
+            node = second[j++];
+            wanted = ((keep & KEEP_SECOND) != 0);
+        }
+        else {
+            node = first[i++];
+            duplicate = second[j++];
+            wanted = ((keep & KEEP_BOTH) != 0);
+        }
+        if(wanted) {
+            merged.push_back(node);
+        }
+        // Objects that aren't kept are owned by the tree, so delete them
+        else {
+            delete node->data;
+            delete node;
+        }
+        if(duplicate != nullptr) {
+            delete duplicate->data;
+            delete duplicate;
+        }
+    }
+}
+
 //----------------------------------------------------------------------------
 // retrieve
 // Preconditions: second NodeData argument is unallocated and is expected to be
@@ -244,12 +886,66 @@ bool BinTree::insert(NodeData* dataptr) {
 // Postconditions: returns true if 1st argument is found in the tree and 2nd
 //                 argument is set to point to this NodeData object, otherwise
 //                 returns false and nothing is done with 2nd argument so it
-//                 still points to garbage
+//                 still points to garbage. In splaying mode the object (or
+//                 its last neighbour) is splayed to the root
+bool BinTree::retrieve(const NodeData& toFind, NodeData*& toReturn) {
+    const BinTree& self = *this;
+    // Only self-adjusting mode restructures, and the hash index turns it off
+    if(!splaying || !hashIndex.empty() || isEmpty()) {
+        return self.retrieve(toFind, toReturn);
+    }
+    // Hot objects are answered from the cache without a splay
+    size_t hash = 0;
+    if(cacheLookup(toFind, hash, toReturn)) {
+        return true;
+    }
+    // Filter proves the object is absent without touching the tree
+    if(!filterMayContain(toFind)) {
+        return false;
+    }
+    // Bring the object (or its last neighbour) to the root, so the next
+    // retrieve of it stops right there
+    root = splayHelper(root, toFind);
+    structureVersion++;
+    if(*root->data == toFind) {
+        toReturn = root->data;
+        cacheStore(hash, root);
+        return true;
+    }
+    if(filter.isEnabled()) {
+        filterFalsePositives++;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// retrieve (const)
+// Preconditions: Same as retrieve
+// Postconditions: Same as retrieve, but the tree's shape is never changed,
+//                 even in splaying mode
 bool BinTree::retrieve(const NodeData& toFind, NodeData*& toReturn) const {
     // Tree is empty, nothing to retrieve here
     if(isEmpty()) {
         return false;
     }
+    // The hash index knows every key, present or not
+    if(!hashIndex.empty()) {
+        Node* node = indexLookup(toFind);
+        if(node == nullptr) {
+            return false;
+        }
+        toReturn = node->data;
+        return true;
+    }
+    // Hot objects are answered from the cache without a descent
+    size_t hash = 0;
+    if(cacheLookup(toFind, hash, toReturn)) {
+        return true;
+    }
+    // Filter proves the object is absent without touching the tree
+    if(!filterMayContain(toFind)) {
+        return false;
+    }
     // Tree has nodes, iteratively search tree for node
     Node* ptr = root;
     bool found = false;
@@ -262,6 +958,7 @@ bool BinTree::retrieve(const NodeData& toFind, NodeData*& toReturn) const {
         else if(*ptr->data == toFind) {
             found = true;
             toReturn = ptr->data;
+            cacheStore(hash, ptr);
         }
         // Search left subtree
         else if(*ptr->data > toFind) {
@@ -273,6 +970,119 @@ bool BinTree::retrieve(const NodeData& toFind, NodeData*& toReturn) const {
             ptr = ptr->right;
         }
     }
+    // Filter let an absent object through
+    if(!found && filter.isEnabled()) {
+        filterFalsePositives++;
+    }
+    return found;
+}
+
+//----------------------------------------------------------------------------
+// retrieve (read-only)
+// Preconditions: Same as retrieve
+// Postconditions: Same as retrieve when the flag is false. When it is true
+//                 the tree and the object are left exactly as they were: no
+//                 splaying, no cache updates and no counters, so any number of
+//                 threads may call it at once as long as none modifies the tree
+bool BinTree::retrieve(const NodeData& toFind, NodeData*& toReturn,
+bool readOnly) const {
+    if(!readOnly) {
+        return retrieve(toFind, toReturn);
+    }
+    // Index probes only read its slots
+    if(!hashIndex.empty()) {
+        const Node* node = indexLookup(toFind);
+        if(node == nullptr) {
+            return false;
+        }
+        toReturn = node->data;
+        return true;
+    }
+    // Filter probes only read its bits
+    if(!filter.mayContain(toFind)) {
+        return false;
+    }
+    const Node* ptr = root;
+    while(ptr != nullptr) {
+        if(*ptr->data == toFind) {
+            toReturn = ptr->data;
+            return true;
+        }
+        ptr = (*ptr->data > toFind ? ptr->left : ptr->right);
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// retrieveBatch
+// Preconditions: first array holds the given number of NodeData objects to
+//                search for, second array has room for as many pointers
+// Postconditions: results[i] points to the NodeData in the tree equal to
+//                 queries[i], or is nullptr if there is none. Searches are
+//                 advanced in lock-step groups, prefetching each search's next
+//                 node while the others run, so their cache misses overlap.
+//                 Returns the number of queries found
+int BinTree::retrieveBatch(const NodeData queries[], int count,
+NodeData* results[]) const {
+    const Node* cursors[RETRIEVE_GROUP];
+    int found = 0;
+    // Every query is a single probe, nothing to interleave
+    if(!hashIndex.empty()) {
+        for(int i = 0; i < count; i++) {
+            const Node* node = indexLookup(queries[i]);
+            results[i] = (node != nullptr ? node->data : nullptr);
+            found += (node != nullptr ? 1 : 0);
+        }
+        return found;
+    }
+    for(int base = 0; base < count; base += RETRIEVE_GROUP) {
+        // Start the next group of searches at the root
+        int size = min(RETRIEVE_GROUP, count - base);
+        int active = 0;
+        for(int i = 0; i < size; i++) {
+            results[base + i] = nullptr;
+            // Searches the filter rules out never start
+            cursors[i] = (filterMayContain(queries[base + i]) ? root : nullptr);
+            if(cursors[i] != nullptr) {
+                active++;
+            }
+        }
+        while(active > 0) {
+            // First pass: request the data of every node about to be compared
+            for(int i = 0; i < size; i++) {
+                if(cursors[i] != nullptr) {
+                    prefetchRead(cursors[i]->data);
+                }
+            }
+            // Second pass: compare, then step and request the next node
+            for(int i = 0; i < size; i++) {
+                const Node* ptr = cursors[i];
+                if(ptr == nullptr) {
+                    continue;
+                }
+                const NodeData& toFind = queries[base + i];
+                if(*ptr->data == toFind) {
+                    results[base + i] = ptr->data;
+                    found++;
+                    ptr = nullptr;
+                }
+                else {
+                    ptr = (*ptr->data > toFind ? ptr->left : ptr->right);
+                }
+                if(ptr == nullptr) {
+                    active--;
+                    // Reached a leaf after the filter let it through
+                    if(results[base + i] == nullptr && filter.isEnabled()) {
+                        filterFalsePositives++;
+                    }
+                }
+                else {
+                    prefetchRead(ptr);
+                }
+                cursors[i] = ptr;
+            }
+        }
+    }
     return found;
 }
 
@@ -293,6 +1103,21 @@ bool BinTree::getSibling(const NodeData & toFind, NodeData& toReturn) const {
     if(*root->data == toFind) {
         return false;
     }
+    // Start from the indexed node and its parent instead of searching
+    if(!hashIndex.empty()) {
+        const Node* node = indexLookup(toFind);
+        if(node == nullptr) {
+            return false;
+        }
+        const Node* parent = parentOf(node);
+        const Node* sibling = (parent->left == node ? parent->right :
+            parent->left);
+        if(sibling == nullptr) {
+            return false;
+        }
+        toReturn = *sibling->data;
+        return true;
+    }
     // Begin recursive search using helper function
     return getSiblingHelper(root, toFind, toReturn);
 }
@@ -355,6 +1180,15 @@ bool BinTree::getParent(const NodeData& toFind, NodeData& toReturn) const {
     if(*root->data == toFind) {
         return false;
     }
+    // Start from the indexed node, one ordered descent finds its parent
+    if(!hashIndex.empty()) {
+        const Node* node = indexLookup(toFind);
+        if(node == nullptr) {
+            return false;
+        }
+        toReturn = *parentOf(node)->data;
+        return true;
+    }
     // Begin recursive search
     return getParentHelper(root, toFind, toReturn);
 }
@@ -451,6 +1285,69 @@ int& index) const {
     return;
 }
 
+//----------------------------------------------------------------------------
+// flatten
+// Preconditions: None
+// Postconditions: The vector argument is replaced by a copy of every object in
+//                 the tree in sorted order, stored contiguously; the tree is
+//                 left unchanged
+void BinTree::flatten(vector<NodeData>& sorted) const {
+    vector<Node*> nodes;
+    flattenHelper(root, nodes);
+    sorted.clear();
+    sorted.reserve(nodes.size());
+    for(const Node* node : nodes) {
+        sorted.push_back(*node->data);
+    }
+}
+
+//----------------------------------------------------------------------------
+// prefixScan
+// Preconditions: None
+// Postconditions: The visitor is called in sorted order on every object whose
+//                 string starts with the NodeData argument's string, stopping
+//                 after the given limit if it is positive. The search seeks
+//                 to the first match along one path and ends at the first
+//                 object past the prefix. Returns the number visited
+int BinTree::prefixScan(const NodeData& prefix,
+const function<void(const NodeData&)>& visitor) const {
+    return prefixScan(prefix, visitor, 0);
+}
+
+int BinTree::prefixScan(const NodeData& prefix,
+const function<void(const NodeData&)>& visitor, int limit) const {
+    const string& text = prefix.getData();
+    // Seek to the first object not less than the prefix, keeping the nodes
+    // still to be visited in order on the stack
+    vector<const Node*> pending;
+    const Node* cur = root;
+    while(cur != nullptr) {
+        if(*cur->data < prefix) {
+            cur = cur->right;
+        }
+        else {
+            pending.push_back(cur);
+            cur = cur->left;
+        }
+    }
+    int visited = 0;
+    while(!pending.empty() && (limit <= 0 || visited < limit)) {
+        cur = pending.back();
+        pending.pop_back();
+        // Objects with the prefix are contiguous, the first one without it
+        // ends the scan
+        if(cur->data->getData().compare(0, text.size(), text) != 0) {
+            break;
+        }
+        visitor(*cur->data);
+        visited++;
+        for(cur = cur->right; cur != nullptr; cur = cur->left) {
+            pending.push_back(cur);
+        }
+    }
+    return visited;
+}
+
 //----------------------------------------------------------------------------
 // arrayToBSTree
 // Preconditions: Array passed as argument is already sorted beforehand, and is
@@ -474,16 +1371,26 @@ void BinTree::arrayToBSTree(NodeData* dataPtrs[]) {
     if(high == 1) {
         insert(dataPtrs[0]);
         dataPtrs[0] = nullptr;
+        rebuildFilter();
         return;
     }
-    // Call helper function
+    // Call helper function, its insert order is balanced already so
+    // rebalancing and splaying are held off meanwhile
+    double alpha = balanceAlpha;
+    bool splay = splaying;
+    balanceAlpha = 0.0;
+    splaying = false;
     arrayToBSTreeHelper(low, high-1, dataPtrs);
+    balanceAlpha = alpha;
+    splaying = splay;
+    // Resize the filter for the new number of keys
+    rebuildFilter();
     return;
 }
 
 void BinTree::arrayToBSTreeHelper(int low, int high, NodeData* dataPtrs[]) {
-    // Boundary exception check
-    if(low < 0 || high < 0) {
+    // Boundary exception check, also stops on an empty sub array
+    if(low < 0 || high < 0 || low > high) {
         return;
     }
     // Base case: sub array size is 1, add the NodeData object from this index
@@ -501,4 +1408,1099 @@ void BinTree::arrayToBSTreeHelper(int low, int high, NodeData* dataPtrs[]) {
     arrayToBSTreeHelper(low, mid-1, dataPtrs);
     // Recursive call on right sub-array
     arrayToBSTreeHelper(mid+1, high, dataPtrs);
-}
\ No newline at end of file
+}
+
+//----------------------------------------------------------------------------
+// bulkLoad
+// Preconditions: Array holds the given number of pointers to dynamically
+//                allocated NodeData objects in any order, duplicates allowed
+// Postconditions: Tree is emptied, the array is sorted and deduplicated (in
+//                 parallel for large batches) and a perfectly balanced tree is
+//                 built from it in one pass. Duplicates are deleted, every
+//                 used index of the array is set to nullptr and the number of
+//                 distinct NodeData objects now in the tree is returned
+int BinTree::bulkLoad(NodeData* dataPtrs[], int count) {
+    // Clear the tree for loading
+    makeEmpty();
+    if(count <= 0) {
+        return 0;
+    }
+    // Sort, then drop duplicates so every key is strictly increasing
+    int distinct = sortUniqueHelper(dataPtrs, count);
+    // Link nodes directly from the sorted array, no comparisons needed
+    root = buildBalancedHelper(dataPtrs, 0, distinct - 1);
+    nodeCount = maxNodeCount = distinct;
+    rebuildFilter();
+    rebuildIndex();
+    return distinct;
+}
+
+BinTree::Node* BinTree::buildBalancedHelper(NodeData* dataPtrs[], int low,
+int high) {
+    // Base case: sub array is empty
+    if(low > high) {
+        return nullptr;
+    }
+    // Middle element becomes the subtree root, same split as arrayToBSTree
+    int mid = (low + high) / 2;
+    Node* ptr = new Node;
+    ptr->data = dataPtrs[mid];
+    dataPtrs[mid] = nullptr;
+    // Recursive calls on left and right sub-arrays
+    ptr->left = buildBalancedHelper(dataPtrs, low, mid - 1);
+    ptr->right = buildBalancedHelper(dataPtrs, mid + 1, high);
+    return ptr;
+}
+
+BinTree::Node* BinTree::linkBalancedHelper(Node* nodes[], int low, int high) {
+    // Base case: sub array is empty
+    if(low > high) {
+        return nullptr;
+    }
+    // Middle node becomes the subtree root
+    int mid = (low + high) / 2;
+    nodes[mid]->left = linkBalancedHelper(nodes, low, mid - 1);
+    nodes[mid]->right = linkBalancedHelper(nodes, mid + 1, high);
+    return nodes[mid];
+}
+
+void BinTree::flattenHelper(Node* curPtr, vector<Node*>& nodes) const {
+    // Base case, node doesn't exist
+    if(curPtr == nullptr) {
+        return;
+    }
+    flattenHelper(curPtr->left, nodes);
+    nodes.push_back(curPtr);
+    flattenHelper(curPtr->right, nodes);
+}
+
+int BinTree::countHelper(const Node* curPtr, int cap) const {
+    // Base case, node doesn't exist or enough nodes were already counted
+    if(curPtr == nullptr || cap <= 0) {
+        return 0;
+    }
+    int leftCount = countHelper(curPtr->left, cap - 1);
+    return 1 + leftCount + countHelper(curPtr->right, cap - 1 - leftCount);
+}
+
+//----------------------------------------------------------------------------
+// insertBatch
+// Preconditions: Array holds the given number of pointers to dynamically
+//                allocated NodeData objects in any order
+// Postconditions: The batch is sorted and merged into the tree in a single
+//                 traversal. Subtrees that receive at least as many new keys
+//                 as they hold are rebuilt balanced. inserted[i] is true and
+//                 index i of the array is set to nullptr if that object was
+//                 added; duplicates (of the tree or of an earlier index) are
+//                 left in the array for the caller to delete. Returns the
+//                 number of objects added
+int BinTree::insertBatch(NodeData* dataPtrs[], int count,
+vector<bool>& inserted) {
+    inserted.assign(count > 0 ? count : 0, false);
+    if(count <= 0) {
+        return 0;
+    }
+    // Sort positions rather than pointers so outcomes map back to the
+    // caller's order, stable so the earliest of equal objects wins
+    vector<int> order(count);
+    for(int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), [dataPtrs](int lhs, int rhs) {
+        return *dataPtrs[lhs] < *dataPtrs[rhs];
+    });
+    return insertBatchHelper(root, dataPtrs, order.data(), 0, count - 1,
+        inserted);
+}
+
+int BinTree::insertBatchHelper(Node*& curPtr, NodeData* dataPtrs[],
+const int order[], int low, int high, vector<bool>& inserted) {
+    // Base case: no keys of the batch fall in this subtree
+    if(low > high) {
+        return 0;
+    }
+    // Empty spot, or a subtree no bigger than the run headed into it:
+    // merging the two sorted sequences beats descending once per key
+    int runLength = high - low + 1;
+    if(curPtr == nullptr || (runLength >= BATCH_REBUILD_CUTOFF &&
+    countHelper(curPtr, runLength + 1) <= runLength)) {
+        return mergeRebuildHelper(curPtr, dataPtrs, order, low, high,
+            inserted);
+    }
+    // Partition the run around this node's key, equal keys are duplicates
+    const NodeData& key = *curPtr->data;
+    const int* first = lower_bound(order + low, order + high + 1, key,
+        [dataPtrs](int idx, const NodeData& nd) {
+            return *dataPtrs[idx] < nd;
+        });
+    const int* last = upper_bound(first, order + high + 1, key,
+        [dataPtrs](const NodeData& nd, int idx) {
+            return nd < *dataPtrs[idx];
+        });
+    int split = static_cast<int>(first - order);
+    int resume = static_cast<int>(last - order);
+    // Recursive calls on the left and right subtrees with their sub-runs
+    return insertBatchHelper(curPtr->left, dataPtrs, order, low, split - 1,
+        inserted) + insertBatchHelper(curPtr->right, dataPtrs, order, resume,
+        high, inserted);
+}
+
+int BinTree::mergeRebuildHelper(Node*& curPtr, NodeData* dataPtrs[],
+const int order[], int low, int high, vector<bool>& inserted) {
+    vector<Node*> nodes;
+    flattenHelper(curPtr, nodes);
+    vector<Node*> merged;
+    merged.reserve(nodes.size() + (high - low + 1));
+    size_t next = 0;
+    int added = 0;
+    for(int i = low; i <= high; i++) {
+        NodeData* ptr = dataPtrs[order[i]];
+        // Existing nodes that sort before this key keep their place
+        while(next < nodes.size() && *nodes[next]->data < *ptr) {
+            merged.push_back(nodes[next++]);
+        }
+        // Already in the subtree, or an earlier batch entry had this key
+        if((next < nodes.size() && *nodes[next]->data == *ptr) ||
+        (!merged.empty() && *merged.back()->data == *ptr)) {
+            continue;
+        }
+        Node* node = new Node;
+        node->data = ptr;
+        node->left = node->right = nullptr;
+        merged.push_back(node);
+        // Not linked yet, a filter rebuild now would miss it
+        recordUnlinked(node);
+        dataPtrs[order[i]] = nullptr;
+        inserted[order[i]] = true;
+        added++;
+    }
+    while(next < nodes.size()) {
+        merged.push_back(nodes[next++]);
+    }
+    // Relink everything balanced in place of the old subtree
+    curPtr = linkBalancedHelper(merged.data(), 0,
+        static_cast<int>(merged.size()) - 1);
+    growFilter();
+    // Existing nodes moved, paths into this subtree are stale
+    if(!nodes.empty()) {
+        structureVersion++;
+    }
+    return added;
+}
+
+int BinTree::sortUniqueHelper(NodeData* dataPtrs[], int count) {
+    int workers = static_cast<int>(thread::hardware_concurrency());
+    // Small batches (or a single core) aren't worth the thread start-up cost
+    if(workers < 2 || count < PARALLEL_SORT_CUTOFF) {
+        sort(dataPtrs, dataPtrs + count, dataLess);
+        return uniqueHelper(dataPtrs, count);
+    }
+    // Split the array into one run per worker
+    vector<int> bounds(workers + 1);
+    vector<int> lengths(workers);
+    for(int i = 0; i <= workers; i++) {
+        bounds[i] = static_cast<int>(static_cast<long long>(count) * i /
+            workers);
+    }
+    // Sort and deduplicate every run on its own thread
+    vector<thread> pool;
+    for(int i = 0; i < workers; i++) {
+        pool.emplace_back([=, &lengths]() {
+            NodeData** run = dataPtrs + bounds[i];
+            int length = bounds[i + 1] - bounds[i];
+            sort(run, run + length, dataLess);
+            lengths[i] = uniqueHelper(run, length);
+        });
+    }
+    for(thread& t : pool) {
+        t.join();
+    }
+    // Close the gaps left by the deleted duplicates so runs are contiguous
+    int end = lengths[0];
+    for(int i = 1; i < workers; i++) {
+        for(int j = 0; j < lengths[i]; j++) {
+            NodeData* ptr = dataPtrs[bounds[i] + j];
+            dataPtrs[bounds[i] + j] = nullptr;
+            dataPtrs[end + j] = ptr;
+        }
+        bounds[i] = end;
+        end += lengths[i];
+    }
+    bounds[workers] = end;
+    // Merge neighbouring runs pairwise, each round in parallel
+    for(int width = 1; width < workers; width *= 2) {
+        pool.clear();
+        for(int i = 0; i + width < workers; i += 2 * width) {
+            NodeData** first = dataPtrs + bounds[i];
+            NodeData** middle = dataPtrs + bounds[i + width];
+            NodeData** last = dataPtrs + bounds[min(i + 2 * width, workers)];
+            pool.emplace_back([=]() {
+                inplace_merge(first, middle, last, dataLess);
+            });
+        }
+        for(thread& t : pool) {
+            t.join();
+        }
+    }
+    // Runs were unique on their own, so only keys shared by runs remain
+    return uniqueHelper(dataPtrs, end);
+}
+
+int BinTree::uniqueHelper(NodeData* dataPtrs[], int count) {
+    if(count == 0) {
+        return 0;
+    }
+    // Keep the first of every run of equal objects, delete the rest
+    int kept = 1;
+    for(int i = 1; i < count; i++) {
+        NodeData* ptr = dataPtrs[i];
+        dataPtrs[i] = nullptr;
+        if(*ptr == *dataPtrs[kept - 1]) {
+            delete ptr;
+        }
+        else {
+            dataPtrs[kept++] = ptr;
+        }
+    }
+    return kept;
+}
+
+//----------------------------------------------------------------------------
+// save
+// Preconditions: The ostream was opened in binary mode
+// Postconditions: A snapshot of the tree's shape and objects is written in
+//                 one in-order pass: a versioned header with a checksum, then
+//                 each object's depth and string. Filter, cache, index and
+//                 balancing settings aren't part of it. Returns false if the
+//                 stream failed
+bool BinTree::save(ostream& out) const {
+    string payload;
+    uint64_t count = 0;
+    // Iterative in-order walk, so degenerate trees don't exhaust the stack
+    vector<pair<const Node*, uint64_t>> pending;
+    const Node* cur = root;
+    uint64_t depth = 0;
+    while(cur != nullptr || !pending.empty()) {
+        for(; cur != nullptr; cur = cur->left, depth++) {
+            pending.push_back(make_pair(cur, depth));
+        }
+        cur = pending.back().first;
+        depth = pending.back().second;
+        pending.pop_back();
+        const string& key = cur->data->getData();
+        putVarint(payload, depth);
+        putVarint(payload, key.size());
+        payload.append(key);
+        count++;
+        cur = cur->right;
+        depth++;
+    }
+    char header[SNAPSHOT_HEADER_BYTES];
+    size_t offset = 0;
+    putValue<uint32_t>(header, offset, SNAPSHOT_MAGIC);
+    putValue<uint32_t>(header, offset, SNAPSHOT_VERSION);
+    putValue<uint64_t>(header, offset, count);
+    putValue<uint64_t>(header, offset, payload.size());
+    putValue<uint64_t>(header, offset, checksum(payload.data(),
+        payload.size()));
+    out.write(header, sizeof(header));
+    out.write(payload.data(), payload.size());
+    return static_cast<bool>(out);
+}
+
+//----------------------------------------------------------------------------
+// load
+// Preconditions: The istream was opened in binary mode
+// Postconditions: If the stream holds a snapshot written by save, of this
+//                 version, with a matching checksum, strictly increasing
+//                 objects and depths that form a tree, the tree is replaced
+//                 by one of the same shape holding copies of its objects,
+//                 linked directly without searching, and true is returned.
+//                 Otherwise the tree is unchanged and false is returned
+bool BinTree::load(istream& in) {
+    char header[SNAPSHOT_HEADER_BYTES];
+    if(!in.read(header, sizeof(header))) {
+        return false;
+    }
+    size_t offset = 0;
+    uint32_t magic = getValue<uint32_t>(header, offset);
+    uint32_t version = getValue<uint32_t>(header, offset);
+    uint64_t count = getValue<uint64_t>(header, offset);
+    uint64_t bytes = getValue<uint64_t>(header, offset);
+    uint64_t sum = getValue<uint64_t>(header, offset);
+    // Every object takes at least two bytes, its depth and its length
+    if(magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION ||
+    count > static_cast<uint64_t>(INT_MAX) || count * 2 > bytes) {
+        return false;
+    }
+    string payload;
+    while(payload.size() < bytes) {
+        size_t piece = static_cast<size_t>(min<uint64_t>(bytes -
+            payload.size(), SNAPSHOT_READ_BYTES));
+        size_t used = payload.size();
+        payload.resize(used + piece);
+        if(!in.read(&payload[used], piece)) {
+            return false;
+        }
+    }
+    if(checksum(payload.data(), payload.size()) != sum) {
+        return false;
+    }
+    // Objects arrive in order with their depths. A node's left child is the
+    // shallowest of the deeper nodes just before it, and a node becomes the
+    // right child of the deepest shallower node before it; the stack holds
+    // the right spine built so far. Linking needs no search, but the keys
+    // must be strictly increasing and every node must sit exactly one level
+    // below its parent, or the snapshot doesn't describe a search tree
+    vector<Node*> nodes;
+    nodes.reserve(static_cast<size_t>(count));
+    vector<pair<Node*, uint64_t>> spine;
+    const char* pos = payload.data();
+    const char* end = pos + payload.size();
+    bool valid = true;
+    while(valid && pos < end) {
+        uint64_t depth;
+        uint64_t length;
+        if(nodes.size() == count || !getVarint(pos, end, depth) ||
+        !getVarint(pos, end, length) ||
+        length > static_cast<uint64_t>(end - pos)) {
+            valid = false;
+            break;
+        }
+        Node* ptr = new Node;
+        ptr->data = new NodeData(pos, static_cast<size_t>(length));
+        ptr->left = nullptr;
+        ptr->right = nullptr;
+        nodes.push_back(ptr);
+        pos += length;
+        if(nodes.size() > 1 && !(*nodes[nodes.size() - 2]->data <
+        *ptr->data)) {
+            valid = false;
+        }
+        // Each node popped is the parent of the one popped before it, and
+        // the last one popped is the new node's left child
+        uint64_t childDepth = 0;
+        while(!spine.empty() && spine.back().second > depth) {
+            if(ptr->left != nullptr && childDepth != spine.back().second + 1) {
+                valid = false;
+            }
+            ptr->left = spine.back().first;
+            childDepth = spine.back().second;
+            spine.pop_back();
+        }
+        if(ptr->left != nullptr && childDepth != depth + 1) {
+            valid = false;
+        }
+        if(!spine.empty()) {
+            spine.back().first->right = ptr;
+        }
+        spine.push_back(make_pair(ptr, depth));
+    }
+    // What is left is the root's right spine, one level per node
+    for(size_t i = 0; valid && i < spine.size(); i++) {
+        valid = (spine[i].second == i);
+    }
+    if(!valid || nodes.size() != count) {
+        for(Node* ptr : nodes) {
+            delete ptr->data;
+            delete ptr;
+        }
+        return false;
+    }
+    makeEmpty();
+    root = (spine.empty() ? nullptr : spine.front().first);
+    nodeCount = maxNodeCount = static_cast<int>(count);
+    rebuildFilter();
+    rebuildIndex();
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// enableFilter
+// Preconditions: bits per key is positive, about 10 gives a 1% false-positive
+//                rate
+// Postconditions: A Bloom filter sized for the current keys is built and is
+//                 then kept up to date by every insert
+void BinTree::enableFilter(int bitsPerKey) {
+    filter = BloomFilter(MIN_FILTER_KEYS, bitsPerKey);
+    rebuildFilter();
+}
+
+//----------------------------------------------------------------------------
+// disableFilter
+// Preconditions: None
+// Postconditions: The Bloom filter is dropped, retrieve always searches
+void BinTree::disableFilter() {
+    filter = BloomFilter();
+}
+
+//----------------------------------------------------------------------------
+// enableCache
+// Preconditions: slot count is positive
+// Postconditions: An empty direct-mapped cache of recently retrieved nodes is
+//                 created, the slot count is rounded up to a power of 2
+void BinTree::enableCache(int slots) {
+    size_t size = 1;
+    while(size < static_cast<size_t>(slots)) {
+        size *= 2;
+    }
+    cache.assign(size, CacheSlot());
+}
+
+//----------------------------------------------------------------------------
+// disableCache
+// Preconditions: None
+// Postconditions: The cache is dropped, retrieve always searches
+void BinTree::disableCache() {
+    cache.clear();
+}
+
+//----------------------------------------------------------------------------
+// enableHashIndex
+// Preconditions: None
+// Postconditions: An open-addressing hash index from every key to its node is
+//                 built and kept in step by every change to the tree. While
+//                 it is on, retrieve, retrieveBatch, getParent and getSibling
+//                 start from the indexed node (absent keys are answered
+//                 without touching the tree) and retrieve no longer splays;
+//                 ordered operations still use the tree. Trees taking nodes
+//                 by split, join or a set operation re-index them in O(n)
+void BinTree::enableHashIndex() {
+    hashIndex.assign(MIN_INDEX_SLOTS, IndexSlot());
+    indexedNodes = 0;
+    rebuildIndex();
+}
+
+//----------------------------------------------------------------------------
+// disableHashIndex
+// Preconditions: None
+// Postconditions: The hash index is dropped, lookups search the tree again
+void BinTree::disableHashIndex() {
+    hashIndex.clear();
+    indexedNodes = 0;
+}
+
+//----------------------------------------------------------------------------
+// setRebalancing
+// Preconditions: alpha is greater than 0.5 and less than 1, or 0 to turn
+//                rebalancing off
+// Postconditions: Whenever insert or hinted insert places a node deeper than
+//                 log base 1/alpha of the node count, the lowest ancestor
+//                 holding more than alpha of its subtree on the new node's
+//                 side is rebuilt balanced in place
+void BinTree::setRebalancing(double alpha) {
+    balanceAlpha = (alpha > 0.5 && alpha < 1.0 ? alpha : 0.0);
+}
+
+//----------------------------------------------------------------------------
+// setSplaying
+// Preconditions: None
+// Postconditions: When true, insert and retrieve splay the object they reach
+//                 to the root, so recently used keys stay near the top and
+//                 setRebalancing has no effect; retrieveBatch and the
+//                 read-only retrieve still search without restructuring
+void BinTree::setSplaying(bool enabled) {
+    splaying = enabled;
+}
+
+//----------------------------------------------------------------------------
+// getStats
+// Preconditions: None
+// Postconditions: Returns the counters gathered since the tree was created or
+//                 resetStats was last called
+BinTree::Stats BinTree::getStats() const {
+    Stats stats;
+    stats.filterBitsPerKey = filter.getBitsPerKey();
+    stats.filterRejects = filterRejects;
+    stats.filterFalsePositives = filterFalsePositives;
+    long long absent = filterRejects + filterFalsePositives;
+    stats.filterFalsePositiveRate = (absent == 0 ? 0.0 :
+        static_cast<double>(filterFalsePositives) / absent);
+    stats.filterExpectedRate = filter.expectedFalsePositiveRate();
+    stats.cacheSlots = static_cast<int>(cache.size());
+    stats.cacheHits = cacheHits;
+    stats.cacheMisses = cacheMisses;
+    stats.hashIndexSlots = static_cast<int>(hashIndex.size());
+    stats.rebuilds = rebuilds;
+    stats.rebuiltNodes = rebuiltNodes;
+    return stats;
+}
+
+//----------------------------------------------------------------------------
+// resetStats
+// Preconditions: None
+// Postconditions: All counters reported by getStats are set to 0
+void BinTree::resetStats() {
+    filterRejects = 0;
+    filterFalsePositives = 0;
+    cacheHits = 0;
+    cacheMisses = 0;
+    rebuilds = 0;
+    rebuiltNodes = 0;
+}
+
+void BinTree::recordInsert(Node* node) {
+    recordUnlinked(node);
+    growFilter();
+}
+
+void BinTree::recordUnlinked(Node* node) {
+    insertVersion++;
+    // While the count is unknown the peak still has to stay an upper bound
+    if(nodeCount >= 0) {
+        nodeCount++;
+        maxNodeCount = max(maxNodeCount, nodeCount);
+    }
+    else {
+        maxNodeCount++;
+    }
+    if(filter.isEnabled()) {
+        filter.add(*node->data);
+    }
+    if(!hashIndex.empty()) {
+        indexInsert(node);
+    }
+}
+
+void BinTree::growFilter() {
+    // Past its sizing the false-positive rate climbs, so grow it
+    if(filter.isEnabled() && filter.getKeys() > filter.getCapacity()) {
+        rebuildFilter();
+    }
+}
+
+void BinTree::recordRemove(Node* node) {
+    if(nodeCount >= 0) {
+        nodeCount--;
+    }
+    // Only this node's cache slot can point at it
+    if(!cache.empty()) {
+        CacheSlot& slot = cache[node->data->hash() & (cache.size() - 1)];
+        if(slot.node == node) {
+            slot = CacheSlot();
+        }
+    }
+    if(!hashIndex.empty()) {
+        indexRemove(node);
+    }
+}
+
+void BinTree::afterRemove() {
+    // Scapegoat rule for deletions: rebuild everything once the tree has
+    // shrunk below alpha of its size at the last full rebuild
+    if(balanceAlpha != 0.0 && !splaying && countNodes() < balanceAlpha *
+    maxNodeCount) {
+        vector<Node*> nodes;
+        flattenHelper(root, nodes);
+        root = linkBalancedHelper(nodes.data(), 0,
+            static_cast<int>(nodes.size()) - 1);
+        maxNodeCount = nodeCount;
+        rebuilds++;
+        rebuiltNodes += static_cast<long long>(nodes.size());
+    }
+    // A Bloom filter can't unset bits, refresh it once removed keys dominate
+    if(filter.isEnabled() && filter.getKeys() > 2 * countNodes() +
+    MIN_FILTER_KEYS) {
+        rebuildFilter();
+    }
+}
+
+void BinTree::recordClear() {
+    structureVersion++;
+    nodeCount = 0;
+    maxNodeCount = 0;
+    filter.clear();
+    // Every cached node was just deleted
+    cache.assign(cache.size(), CacheSlot());
+    // So was every indexed one, start again from the smallest index
+    if(!hashIndex.empty()) {
+        hashIndex.assign(MIN_INDEX_SLOTS, IndexSlot());
+        indexedNodes = 0;
+    }
+}
+
+bool BinTree::filterMayContain(const NodeData& toFind) const {
+    if(filter.mayContain(toFind)) {
+        return true;
+    }
+    filterRejects++;
+    return false;
+}
+
+void BinTree::rebuildFilter() {
+    if(!filter.isEnabled()) {
+        return;
+    }
+    // Size for the keys present plus headroom for later inserts
+    int keys = countNodes();
+    int capacity = keys + keys / 4;
+    filter = BloomFilter(max(capacity, MIN_FILTER_KEYS),
+        filter.getBitsPerKey());
+    fillFilterHelper(root);
+}
+
+void BinTree::fillFilterHelper(const Node* curPtr) {
+    // Base case, node doesn't exist
+    if(curPtr == nullptr) {
+        return;
+    }
+    filter.add(*curPtr->data);
+    fillFilterHelper(curPtr->left);
+    fillFilterHelper(curPtr->right);
+}
+
+bool BinTree::cacheLookup(const NodeData& toFind, size_t& hash,
+NodeData*& toReturn) const {
+    if(cache.empty()) {
+        return false;
+    }
+    hash = toFind.hash();
+    // Slot count is a power of 2, so the low bits pick the slot
+    const CacheSlot& slot = cache[hash & (cache.size() - 1)];
+    if(slot.node != nullptr && slot.hash == hash &&
+    *slot.node->data == toFind) {
+        cacheHits++;
+        toReturn = slot.node->data;
+        return true;
+    }
+    cacheMisses++;
+    return false;
+}
+
+void BinTree::cacheStore(size_t hash, Node* node) const {
+    if(cache.empty()) {
+        return;
+    }
+    // Direct-mapped, the newest node takes the slot
+    CacheSlot& slot = cache[hash & (cache.size() - 1)];
+    slot.hash = hash;
+    slot.node = node;
+}
+
+BinTree::Node* BinTree::indexLookup(const NodeData& toFind) const {
+    size_t hash = toFind.hash();
+    size_t mask = hashIndex.size() - 1;
+    // Linear probing: the key is in the run of used slots after its home
+    for(size_t i = hash & mask; hashIndex[i].node != nullptr;
+    i = (i + 1) & mask) {
+        if(hashIndex[i].hash == hash && *hashIndex[i].node->data == toFind) {
+            return hashIndex[i].node;
+        }
+    }
+    return nullptr;
+}
+
+void BinTree::indexInsert(Node* node) {
+    // Keep at least half the slots free so probe runs stay short
+    if(2 * static_cast<size_t>(indexedNodes + 1) > hashIndex.size()) {
+        resizeIndex(2 * hashIndex.size());
+    }
+    size_t hash = node->data->hash();
+    size_t mask = hashIndex.size() - 1;
+    size_t i = hash & mask;
+    while(hashIndex[i].node != nullptr) {
+        i = (i + 1) & mask;
+    }
+    hashIndex[i].hash = hash;
+    hashIndex[i].node = node;
+    indexedNodes++;
+}
+
+void BinTree::indexRemove(Node* node) {
+    size_t mask = hashIndex.size() - 1;
+    size_t i = node->data->hash() & mask;
+    while(hashIndex[i].node != node) {
+        // Not indexed, nothing to drop
+        if(hashIndex[i].node == nullptr) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    // Shift later entries of the run back into the gap unless that would
+    // move one before its home slot, so no tombstones are needed
+    size_t j = i;
+    for(;;) {
+        j = (j + 1) & mask;
+        if(hashIndex[j].node == nullptr) {
+            break;
+        }
+        size_t home = hashIndex[j].hash & mask;
+        bool between = (i <= j ? (i < home && home <= j) :
+            (i < home || home <= j));
+        if(!between) {
+            hashIndex[i] = hashIndex[j];
+            i = j;
+        }
+    }
+    hashIndex[i] = IndexSlot();
+    indexedNodes--;
+}
+
+void BinTree::resizeIndex(size_t slots) {
+    vector<IndexSlot> old(slots);
+    old.swap(hashIndex);
+    size_t mask = slots - 1;
+    for(const IndexSlot& slot : old) {
+        if(slot.node == nullptr) {
+            continue;
+        }
+        size_t i = slot.hash & mask;
+        while(hashIndex[i].node != nullptr) {
+            i = (i + 1) & mask;
+        }
+        hashIndex[i] = slot;
+    }
+}
+
+void BinTree::rebuildIndex() {
+    if(hashIndex.empty()) {
+        return;
+    }
+    // Size for the keys present at under half load
+    size_t slots = MIN_INDEX_SLOTS;
+    while(slots < 2 * static_cast<size_t>(countNodes()) + 2) {
+        slots *= 2;
+    }
+    hashIndex.assign(slots, IndexSlot());
+    indexedNodes = 0;
+    fillIndexHelper(root);
+}
+
+void BinTree::fillIndexHelper(Node* curPtr) {
+    // Base case, node doesn't exist
+    if(curPtr == nullptr) {
+        return;
+    }
+    indexInsert(curPtr);
+    fillIndexHelper(curPtr->left);
+    fillIndexHelper(curPtr->right);
+}
+
+const BinTree::Node* BinTree::parentOf(const Node* node) const {
+    // Node is known to be in the tree below the root, so the search for its
+    // key always reaches a node with it as a child
+    const Node* curPtr = root;
+    while(curPtr->left != node && curPtr->right != node) {
+        curPtr = (*node->data < *curPtr->data ? curPtr->left : curPtr->right);
+    }
+    return curPtr;
+}
+
+//----------------------------------------------------------------------------
+// getHeight
+// Preconditions: None
+// Postconditions: Returns the number of nodes on the longest root-to-leaf
+//                 path, 0 if the tree is empty
+int BinTree::getHeight() const {
+    return heightHelper(root);
+}
+
+int BinTree::heightHelper(const Node* curPtr) const {
+    // Base case, node doesn't exist
+    if(curPtr == nullptr) {
+        return 0;
+    }
+    return 1 + max(heightHelper(curPtr->left), heightHelper(curPtr->right));
+}
+
+bool BinTree::insertBelow(Node* current, Node* ptr) {
+    // Same walk as insert, starting from the given node instead of the root
+    for(;;) {
+        if(*ptr->data < *current->data) {
+            if(current->left == nullptr) {
+                current->left = ptr;
+                return true;
+            }
+            current = current->left;
+        }
+        else if(*ptr->data > *current->data) {
+            if(current->right == nullptr) {
+                current->right = ptr;
+                return true;
+            }
+            current = current->right;
+        }
+        else {
+            return false;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Finger default constructor
+// Preconditions: None
+// Postconditions: Finger holds no path, the first hinted insert starts at
+//                 the root
+BinTree::Finger::Finger() {
+    owner = nullptr;
+    version = 0;
+}
+
+// number of trailing zero bits, i.e. the height of the node at a 1-based
+// in-order position of a perfectly balanced tree
+static int trailingZeros(long long index) {
+    int zeros = 0;
+    while((index & 1) == 0) {
+        index >>= 1;
+        zeros++;
+    }
+    return zeros;
+}
+
+//----------------------------------------------------------------------------
+// Builder constructor
+// Preconditions: None
+// Postconditions: The tree is emptied and is built by later calls to add
+BinTree::Builder::Builder(BinTree& toBuild) : tree(toBuild) {
+    tree.makeEmpty();
+    orphan = nullptr;
+    last = nullptr;
+    count = 0;
+    version = tree.structureVersion;
+    inserts = tree.insertVersion;
+}
+
+//----------------------------------------------------------------------------
+// add
+// Preconditions: NodeData is dynamically allocated and comparable to those in
+//                the tree
+// Postconditions: NodeData is added and true is returned, or false if it is a
+//                 duplicate, in which case the caller still owns it. If the
+//                 tree was restructured or inserted into by anything else
+//                 since the last add, keys are inserted with a Finger from
+//                 then on
+bool BinTree::Builder::add(NodeData* dataptr) {
+    // Someone else relinked nodes or hung a key below the spine, the spine
+    // we kept is no longer valid
+    if(version != tree.structureVersion || inserts != tree.insertVersion) {
+        return tree.insert(finger, dataptr);
+    }
+    Node* ptr = new Node;
+    ptr->data = dataptr;
+    ptr->left = ptr->right = nullptr;
+    // New largest key, place it by its position in the stream
+    if(last == nullptr || *dataptr > *last->data) {
+        append(ptr);
+        version = ++tree.structureVersion;
+        tree.recordInsert(ptr);
+        inserts = tree.insertVersion;
+        return true;
+    }
+    // Out of order: the lowest spine node still less than the key bounds
+    // where it can go, everything below it hangs off its right pointer
+    Node* start = tree.root;
+    for(size_t i = pending.size(); i-- > 0; ) {
+        if(*pending[i].node->data < *dataptr) {
+            start = pending[i].node->right;
+            break;
+        }
+    }
+    if(!tree.insertBelow(start, ptr)) {
+        delete ptr;
+        return false;
+    }
+    tree.recordInsert(ptr);
+    inserts = tree.insertVersion;
+    return true;
+}
+
+void BinTree::Builder::append(Node* ptr) {
+    // In a perfectly balanced tree the node at in-order position i has
+    // height h = trailingZeros(i), its left subtree is the 2^h - 1 keys
+    // before it and its right subtree the 2^h - 1 keys after it
+    long long index = ++count;
+    int height = trailingZeros(index);
+    last = ptr;
+    if(height > 0) {
+        // Left subtree is complete, it is the orphan, right is still to come
+        ptr->left = orphan;
+        orphan = nullptr;
+        hang(ptr);
+        pending.push_back({ptr, index});
+        return;
+    }
+    // A leaf completes at once, and may complete the parents waiting for it
+    Node* current = ptr;
+    while(((index >> (height + 1)) & 1) == 1 && !pending.empty()) {
+        // Right child, its parent is the bottom of the spine and is done too
+        Pending parent = pending.back();
+        pending.pop_back();
+        parent.node->right = current;
+        current = parent.node;
+        index = parent.index;
+        height = trailingZeros(index);
+    }
+    // Left child, its parent comes later in the stream
+    orphan = current;
+    hang(current);
+}
+
+void BinTree::Builder::hang(Node* subtree) {
+    // Until its real parent arrives a subtree hangs below the spine's bottom,
+    // which keeps the tree connected and ordered between adds
+    if(pending.empty()) {
+        tree.root = subtree;
+    }
+    else {
+        pending.back().node->right = subtree;
+    }
+}
+
+bool BinTree::tooDeep(int depth) const {
+    if(balanceAlpha == 0.0 || splaying || maxNodeCount < 2) {
+        return false;
+    }
+    return depth > log(static_cast<double>(maxNodeCount)) /
+        log(1.0 / balanceAlpha);
+}
+
+void BinTree::rebalanceAfterInsert(const NodeData& key, int depth) {
+    if(!tooDeep(depth)) {
+        return;
+    }
+    // Plain insert keeps no path, so walk it again; this only happens when
+    // a rebuild is due and costs far less than the rebuild itself
+    vector<Node*> path;
+    Node* current = root;
+    while(current != nullptr) {
+        path.push_back(current);
+        if(*current->data == key) {
+            break;
+        }
+        current = (key < *current->data ? current->left : current->right);
+    }
+    rebuildScapegoat(path);
+}
+
+int BinTree::rebuildScapegoat(vector<Node*>& path) {
+    // Walk up from the new leaf adding up subtree sizes until an ancestor
+    // has too many of its nodes on the path's side
+    int childSize = 1;
+    int scapegoat = 0;
+    int size = 1;
+    for(int i = static_cast<int>(path.size()) - 2; i >= 0; i--) {
+        Node* other = (path[i]->left == path[i + 1] ? path[i]->right :
+            path[i]->left);
+        size = childSize + 1 + countHelper(other, INT_MAX);
+        if(childSize > balanceAlpha * size) {
+            scapegoat = i;
+            break;
+        }
+        childSize = size;
+    }
+    // Flatten the scapegoat's subtree and relink it balanced in its place
+    vector<Node*> nodes;
+    flattenHelper(path[scapegoat], nodes);
+    Node* subtree = linkBalancedHelper(nodes.data(), 0,
+        static_cast<int>(nodes.size()) - 1);
+    if(scapegoat == 0) {
+        root = subtree;
+        maxNodeCount = countNodes();
+    }
+    else if(path[scapegoat - 1]->left == path[scapegoat]) {
+        path[scapegoat - 1]->left = subtree;
+    }
+    else {
+        path[scapegoat - 1]->right = subtree;
+    }
+    structureVersion++;
+    rebuilds++;
+    rebuiltNodes += static_cast<long long>(nodes.size());
+    return scapegoat;
+}
+
+BinTree::Node* BinTree::splayHelper(Node* curPtr, const NodeData& key) {
+    // Top-down splay: nodes less than the key are gathered on a left tree,
+    // greater ones on a right tree, then both hang off the new root
+    Node header;
+    header.left = header.right = nullptr;
+    Node* leftMax = &header;     // largest node of the left tree
+    Node* rightMin = &header;    // smallest node of the right tree
+    for(;;) {
+        if(key < *curPtr->data) {
+            if(curPtr->left == nullptr) {
+                break;
+            }
+            // Zig-zig: rotate right first
+            if(key < *curPtr->left->data) {
+                Node* child = curPtr->left;
+                curPtr->left = child->right;
+                child->right = curPtr;
+                curPtr = child;
+                if(curPtr->left == nullptr) {
+                    break;
+                }
+            }
+            // Link the current node into the right tree
+            rightMin->left = curPtr;
+            rightMin = curPtr;
+            curPtr = curPtr->left;
+        }
+        else if(key > *curPtr->data) {
+            if(curPtr->right == nullptr) {
+                break;
+            }
+            // Zag-zag: rotate left first
+            if(key > *curPtr->right->data) {
+                Node* child = curPtr->right;
+                curPtr->right = child->left;
+                child->left = curPtr;
+                curPtr = child;
+                if(curPtr->right == nullptr) {
+                    break;
+                }
+            }
+            // Link the current node into the left tree
+            leftMax->right = curPtr;
+            leftMax = curPtr;
+            curPtr = curPtr->right;
+        }
+        else {
+            break;
+        }
+    }
+    // Reassemble around the last node reached
+    leftMax->right = curPtr->left;
+    rightMin->left = curPtr->right;
+    curPtr->left = header.right;
+    curPtr->right = header.left;
+    return curPtr;
+}
+
+bool BinTree::splayInsert(Node* ptr) {
+    if(isEmpty()) {
+        root = ptr;
+        recordInsert(ptr);
+        return true;
+    }
+    // Splay the new key's neighbour to the root, then split it around the
+    // new node, which becomes the root
+    root = splayHelper(root, *ptr->data);
+    structureVersion++;
+    if(*root->data == *ptr->data) {
+        delete ptr;
+        return false;
+    }
+    if(*ptr->data < *root->data) {
+        ptr->left = root->left;
+        ptr->right = root;
+        root->left = nullptr;
+    }
+    else {
+        ptr->right = root->right;
+        ptr->left = root;
+        root->right = nullptr;
+    }
+    root = ptr;
+    recordInsert(ptr);
+    return true;
+}
+
+int BinTree::countNodes() {
+    // Count is unknown after a split until something needs it
+    if(nodeCount < 0) {
+        nodeCount = countHelper(root, INT_MAX);
+        maxNodeCount = max(maxNodeCount, nodeCount);
+    }
+    return nodeCount;
+}
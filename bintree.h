@@ -9,17 +9,44 @@
 //      --allows the retrieval of parent nodes
 //      --allows the outputting of a Binary Tree to an Array
 //      --allows the building of a Binary Tree from a sorted Array
+//      --allows bulk loading a balanced Binary Tree from an unsorted Array
+//      --allows merging a batch of NodeData objects into an existing tree
+//      --allows retrieving a batch of NodeData objects with interleaved
+//        searches
+//      --allows an optional Bloom filter to answer retrieve misses early
+//      --allows an optional cache of recently retrieved nodes
+//      --allows an optional hash index that answers point lookups without a
+//        descent
+//      --allows hinted inserts that resume from the last insertion path
+//      --allows building a balanced Binary Tree from a sorted stream
+//      --allows automatic partial rebuilds that keep the height logarithmic
+//      --allows a self-adjusting (splay) mode for skewed lookups
+//      --allows removing single objects or a range of objects
+//      --allows splitting a tree at a key and joining two trees
+//      --allows union, intersection and difference of two trees
+//      --allows copying the objects out in sorted order without emptying
+//        the tree
+//      --allows visiting the objects that start with a prefix, in order
+//      --allows saving a binary snapshot and loading it back with the same
+//        shape
 //
 // Implementation and assumptions:
 //      --user will pass pointers to NodeData objects to add nodes to the tree
 //      --array passed to arrayToBSTree() is already sorted beforehand
 //      --for <<, tree outputs data in each node followed by a space
+//      --snapshots use the machine's byte order for their header, they are
+//        a local store rather than an exchange format
+//      --statistics counters, the cache and splaying are not synchronized
+//        between threads, concurrent readers use the read-only retrieve
 //----------------------------------------------------------------------------
 
 #ifndef BINTREE_H
 #define BINTREE_H
 
 #include "nodedata.h"
+#include "bloomfilter.h"
+#include <functional>
+#include <vector>
 using namespace std;
 
 class BinTree {
@@ -31,7 +58,30 @@ class BinTree {
 //                 in an in-order manner
 friend ostream &operator<<(ostream&, const BinTree&);
 
+//----------------------------------------------------------------------------
+// VebIndex
+// Reads the node links directly to copy the tree's exact shape
+friend class VebIndex;
+
 public:
+//----------------------------------------------------------------------------
+// Stats
+// Counters reported by getStats
+struct Stats {
+    int filterBitsPerKey;            // 0 when the filter is disabled
+    long long filterRejects;         // retrieves answered by the filter alone
+    long long filterFalsePositives;  // retrieves the filter let through that
+                                     // then missed in the tree
+    double filterFalsePositiveRate;  // observed, over retrieves of absent keys
+    double filterExpectedRate;       // predicted for the filter's current load
+    int cacheSlots;                  // 0 when the cache is disabled
+    long long cacheHits;             // retrieves answered by the cache
+    long long cacheMisses;           // retrieves the cache could not answer
+    int hashIndexSlots;              // 0 when the hash index is disabled
+    long long rebuilds;              // subtrees rebuilt by rebalancing
+    long long rebuiltNodes;          // nodes relinked by those rebuilds
+};
+
 //----------------------------------------------------------------------------
 // Default constructor
 // Preconditions: None
@@ -97,6 +147,103 @@ bool operator!=(const BinTree &) const;
 //                 which isn't added and false is returned
 bool insert(NodeData*);
 
+class Finger;   // path of the last hinted insert, defined below
+class Builder;  // balanced builder for sorted streams, defined below
+
+//----------------------------------------------------------------------------
+// insert (hinted)
+// Preconditions: NodeData to add is of same type and comparable to those in
+//                the tree; the Finger was last used with this tree or is new
+// Postconditions: Same as insert, but the search starts from the deepest node
+//                 on the Finger's path whose subtree must hold the new object,
+//                 so adjacent keys cost only the distance between them. The
+//                 Finger is updated to the new path
+bool insert(Finger&, NodeData*);
+
+//----------------------------------------------------------------------------
+// getHeight
+// Preconditions: None
+// Postconditions: Returns the number of nodes on the longest root-to-leaf
+//                 path, 0 if the tree is empty
+int getHeight() const;
+
+//----------------------------------------------------------------------------
+// remove
+// Preconditions: second NodeData argument is expected to be used to take
+//                ownership of the removed NodeData
+// Postconditions: returns true if the 1st argument is found, its node is
+//                 unlinked and deleted and the 2nd argument is set to the
+//                 NodeData it held, which the caller now owns. The active
+//                 balancing policy is kept. Otherwise returns false and the
+//                 tree is unchanged
+bool remove(const NodeData&, NodeData*&);
+
+//----------------------------------------------------------------------------
+// removeRange
+// Preconditions: first NodeData argument is not greater than the second
+// Postconditions: Every object from the 1st argument to the 2nd (both
+//                 included) is unlinked and its NodeData appended in order to
+//                 the vector, which the caller now owns. The range is cut
+//                 out along two search paths and the rest joined once, so it
+//                 takes O(height + k) for k removed objects, O(log n + k) on
+//                 a balanced tree. Returns k
+int removeRange(const NodeData&, const NodeData&, vector<NodeData*>&);
+
+//----------------------------------------------------------------------------
+// split
+// Preconditions: The two tree arguments are different trees
+// Postconditions: Objects less than the NodeData argument are moved into the
+//                 1st tree argument and the rest into the 2nd, by relinking
+//                 the nodes along one search path in O(height); no NodeData is
+//                 copied. Both trees' old contents are deleted first, both
+//                 take this tree's settings, and this tree is left empty.
+//                 With a Bloom filter on, each half rebuilds its filter from
+//                 its own objects, which takes O(n).
+//                 Either tree argument may be this tree. If both arguments
+//                 are the same tree nothing is changed
+void split(const NodeData&, BinTree&, BinTree&);
+
+//----------------------------------------------------------------------------
+// join
+// Preconditions: every object in the 1st tree argument is less than every
+//                object in the 2nd
+// Postconditions: This tree's old contents are deleted and it takes the nodes
+//                 of both arguments by relinking in O(height of the 1st); no
+//                 NodeData is copied. Both arguments are left empty, unless
+//                 one of them is this tree. Settings of this tree are kept; a
+//                 Bloom filter is merged when both sides' filters match, else
+//                 rebuilt
+void join(BinTree&, BinTree&);
+
+//----------------------------------------------------------------------------
+// setUnion
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it holds every
+//                 object found in either tree argument, perfectly balanced.
+//                 The in-order sequences are merged in O(n + m) (in parallel
+//                 for large trees) and nodes are relinked, not copied; when
+//                 both hold an object the 2nd tree's copy is deleted. Both
+//                 arguments are left empty, unless one of them is this tree
+void setUnion(BinTree&, BinTree&);
+
+//----------------------------------------------------------------------------
+// setIntersection
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it holds the 1st
+//                 tree's objects that are also in the 2nd, perfectly balanced,
+//                 in O(n + m); every other object is deleted. Both arguments
+//                 are left empty, unless one of them is this tree
+void setIntersection(BinTree&, BinTree&);
+
+//----------------------------------------------------------------------------
+// setDifference
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it holds the 1st
+//                 tree's objects that are not in the 2nd, perfectly balanced,
+//                 in O(n + m); every other object is deleted. Both arguments
+//                 are left empty, unless one of them is this tree
+void setDifference(BinTree&, BinTree&);
+
 //----------------------------------------------------------------------------
 // retrieve
 // Preconditions: second NodeData argument is unallocated and is expected to be
@@ -104,9 +251,37 @@ bool insert(NodeData*);
 // Postconditions: returns true if 1st argument is found in the tree and 2nd
 //                 argument is set to point to this NodeData object, otherwise
 //                 returns false and nothing is done with 2nd argument so it
-//                 still points to garbage
+//                 still points to garbage. In splaying mode the object (or
+//                 its last neighbour) is splayed to the root
+bool retrieve(const NodeData&, NodeData*&);
+
+//----------------------------------------------------------------------------
+// retrieve (const)
+// Preconditions: Same as retrieve
+// Postconditions: Same as retrieve, but the tree's shape is never changed,
+//                 even in splaying mode
 bool retrieve(const NodeData&, NodeData*&) const;
 
+//----------------------------------------------------------------------------
+// retrieve (read-only)
+// Preconditions: Same as retrieve
+// Postconditions: Same as retrieve when the flag is false. When it is true
+//                 the tree and the object are left exactly as they were: no
+//                 splaying, no cache updates and no counters, so any number of
+//                 threads may call it at once as long as none modifies the tree
+bool retrieve(const NodeData&, NodeData*&, bool) const;
+
+//----------------------------------------------------------------------------
+// retrieveBatch
+// Preconditions: first array holds the given number of NodeData objects to
+//                search for, second array has room for as many pointers
+// Postconditions: results[i] points to the NodeData in the tree equal to
+//                 queries[i], or is nullptr if there is none. Searches are
+//                 advanced in lock-step groups, prefetching each search's next
+//                 node while the others run, so their cache misses overlap.
+//                 Returns the number of queries found
+int retrieveBatch(const NodeData [], int, NodeData* []) const;
+
 //----------------------------------------------------------------------------
 // getSibling
 // Preconditions: first NodeData argument exists in the tree and has a sibling
@@ -141,6 +316,26 @@ void displaySideways() const; // displays the tree sideways
 //                 and tree is then emptied.
 void bstreeToArray(NodeData* []);
 
+//----------------------------------------------------------------------------
+// flatten
+// Preconditions: None
+// Postconditions: The vector argument is replaced by a copy of every object in
+//                 the tree in sorted order, stored contiguously; the tree is
+//                 left unchanged
+void flatten(vector<NodeData>&) const;
+
+//----------------------------------------------------------------------------
+// prefixScan
+// Preconditions: None
+// Postconditions: The visitor is called in sorted order on every object whose
+//                 string starts with the NodeData argument's string, stopping
+//                 after the given limit if it is positive. The search seeks
+//                 to the first match along one path and ends at the first
+//                 object past the prefix. Returns the number visited
+int prefixScan(const NodeData&, const function<void(const NodeData&)>&) const;
+int prefixScan(const NodeData&, const function<void(const NodeData&)>&,
+    int) const;
+
 //----------------------------------------------------------------------------
 // arrayToBSTree
 // Preconditions: Array passed as argument is already sorted beforehand, and is
@@ -150,13 +345,164 @@ void bstreeToArray(NodeData* []);
 //                 the array is set to nullptr
 void arrayToBSTree(NodeData* []);
 
+//----------------------------------------------------------------------------
+// bulkLoad
+// Preconditions: Array holds the given number of pointers to dynamically
+//                allocated NodeData objects in any order, duplicates allowed
+// Postconditions: Tree is emptied, the array is sorted and deduplicated (in
+//                 parallel for large batches) and a perfectly balanced tree is
+//                 built from it in one pass. Duplicates are deleted, every
+//                 used index of the array is set to nullptr and the number of
+//                 distinct NodeData objects now in the tree is returned
+int bulkLoad(NodeData* [], int);
+
+//----------------------------------------------------------------------------
+// insertBatch
+// Preconditions: Array holds the given number of pointers to dynamically
+//                allocated NodeData objects in any order
+// Postconditions: The batch is sorted and merged into the tree in a single
+//                 traversal. Subtrees that receive at least as many new keys
+//                 as they hold are rebuilt balanced. inserted[i] is true and
+//                 index i of the array is set to nullptr if that object was
+//                 added; duplicates (of the tree or of an earlier index) are
+//                 left in the array for the caller to delete. Returns the
+//                 number of objects added
+int insertBatch(NodeData* [], int, vector<bool>&);
+
+//----------------------------------------------------------------------------
+// save
+// Preconditions: The ostream was opened in binary mode
+// Postconditions: A snapshot of the tree's shape and objects is written in
+//                 one in-order pass: a versioned header with a checksum, then
+//                 each object's depth and string. Filter, cache, index and
+//                 balancing settings aren't part of it. Returns false if the
+//                 stream failed
+bool save(ostream&) const;
+
+//----------------------------------------------------------------------------
+// load
+// Preconditions: The istream was opened in binary mode
+// Postconditions: If the stream holds a snapshot written by save, of this
+//                 version, with a matching checksum, strictly increasing
+//                 objects and depths that form a tree, the tree is replaced
+//                 by one of the same shape holding copies of its objects,
+//                 linked directly without searching, and true is returned.
+//                 Otherwise the tree is unchanged and false is returned
+bool load(istream&);
+
+//----------------------------------------------------------------------------
+// enableFilter
+// Preconditions: bits per key is positive, about 10 gives a 1% false-positive
+//                rate
+// Postconditions: A Bloom filter sized for the current keys is built and is
+//                 then kept up to date by every insert
+void enableFilter(int);
+
+//----------------------------------------------------------------------------
+// disableFilter
+// Preconditions: None
+// Postconditions: The Bloom filter is dropped, retrieve always searches
+void disableFilter();
+
+//----------------------------------------------------------------------------
+// enableCache
+// Preconditions: slot count is positive
+// Postconditions: An empty direct-mapped cache of recently retrieved nodes is
+//                 created, the slot count is rounded up to a power of 2
+void enableCache(int);
+
+//----------------------------------------------------------------------------
+// disableCache
+// Preconditions: None
+// Postconditions: The cache is dropped, retrieve always searches
+void disableCache();
+
+//----------------------------------------------------------------------------
+// enableHashIndex
+// Preconditions: None
+// Postconditions: An open-addressing hash index from every key to its node is
+//                 built and kept in step by every change to the tree. While
+//                 it is on, retrieve, retrieveBatch, getParent and getSibling
+//                 start from the indexed node (absent keys are answered
+//                 without touching the tree) and retrieve no longer splays;
+//                 ordered operations still use the tree. Trees taking nodes
+//                 by split, join or a set operation re-index them in O(n)
+void enableHashIndex();
+
+//----------------------------------------------------------------------------
+// disableHashIndex
+// Preconditions: None
+// Postconditions: The hash index is dropped, lookups search the tree again
+void disableHashIndex();
+
+//----------------------------------------------------------------------------
+// setRebalancing
+// Preconditions: alpha is greater than 0.5 and less than 1, or 0 to turn
+//                rebalancing off
+// Postconditions: Whenever insert or hinted insert places a node deeper than
+//                 log base 1/alpha of the node count, the lowest ancestor
+//                 holding more than alpha of its subtree on the new node's
+//                 side is rebuilt balanced in place
+void setRebalancing(double);
+
+//----------------------------------------------------------------------------
+// setSplaying
+// Preconditions: None
+// Postconditions: When true, insert and retrieve splay the object they reach
+//                 to the root, so recently used keys stay near the top and
+//                 setRebalancing has no effect; retrieveBatch and the const
+//                 and read-only retrieves still search without restructuring
+void setSplaying(bool);
+
+//----------------------------------------------------------------------------
+// getStats
+// Preconditions: None
+// Postconditions: Returns the counters gathered since the tree was created or
+//                 resetStats was last called
+Stats getStats() const;
+
+//----------------------------------------------------------------------------
+// resetStats
+// Preconditions: None
+// Postconditions: All counters reported by getStats are set to 0
+void resetStats();
+
 private:
     struct Node {
         NodeData* data; // pointer to data object
         Node* left; // left subtree pointer
         Node* right; // right subtree pointer
     };
+    struct CacheSlot {
+        size_t hash = 0; // NodeData::hash() of the cached node's data
+        Node* node = nullptr; // cached node, null if the slot is empty
+    };
     Node* root; // root of the tree
+    BloomFilter filter; // optional membership filter, disabled by default
+    mutable long long filterRejects;        // retrieves the filter answered
+    mutable long long filterFalsePositives; // retrieves it wrongly passed
+    mutable vector<CacheSlot> cache;        // optional, empty when disabled
+    mutable long long cacheHits;            // retrieves the cache answered
+    mutable long long cacheMisses;          // retrieves it could not answer
+    struct IndexSlot {
+        size_t hash = 0; // NodeData::hash() of the indexed node's data
+        Node* node = nullptr; // indexed node, null if the slot is empty
+    };
+    vector<IndexSlot> hashIndex;            // optional, empty when disabled
+    int indexedNodes;                       // nodes in the hash index
+    unsigned long structureVersion;         // bumped whenever nodes are
+                                            // deleted or relinked
+    unsigned long insertVersion;            // bumped by every insert, so a
+                                            // Builder sees keys it didn't
+                                            // add
+    int nodeCount;                          // nodes in the tree, -1 when
+                                            // unknown after a split
+    int maxNodeCount;                       // most nodes since the last
+                                            // rebuild of the whole tree
+    double balanceAlpha;                    // 0 when rebalancing is off
+    bool splaying;                          // self-adjusting mode is on
+    long long rebuilds;                     // rebuilds done by rebalancing
+    long long rebuiltNodes;                 // nodes those rebuilds relinked
     // utility functions
     void inorderHelper(Node*, ostream&) const; // recursive helper for 
                                                // operator<<
@@ -184,6 +530,204 @@ private:
 
     void arrayToBSTreeHelper(int, int,         // recursive helper for
          NodeData* []);                        // arrayToBSTree
+
+    Node* buildBalancedHelper(NodeData* [],    // recursive helper that links
+        int, int);                             // a sorted array into a
+                                               // balanced subtree directly
+
+    Node* linkBalancedHelper(Node* [],         // recursive helper that
+        int, int);                             // relinks in-order nodes into
+                                               // a balanced subtree
+
+    void flattenHelper(Node*,                  // collects the nodes of a
+        vector<Node*>&) const;                 // subtree in-order
+
+    int countHelper(const Node*, int) const;   // subtree size, stops at cap
+
+    int heightHelper(const Node*) const;       // recursive helper for
+                                               // getHeight
+
+    bool insertBelow(Node*, Node*);            // attaches a new node as a leaf
+                                               // under the given node
+
+    bool tooDeep(int) const;                   // whether a new node's depth
+                                               // calls for a rebuild
+
+    void rebalanceAfterInsert(const NodeData&, // finds the path to a new node
+        int);                                  // if it is too deep
+
+    int rebuildScapegoat(vector<Node*>&);      // rebuilds the scapegoat on a
+                                               // root-to-leaf path, returns
+                                               // its index on the path
+
+    Node* splayHelper(Node*,                   // top-down splay, returns the
+        const NodeData&);                      // new subtree root
+
+    bool splayInsert(Node*);                   // insert for splaying mode
+
+    int insertBatchHelper(Node*&, NodeData* [],// recursive helper for
+        const int [], int, int,                // insertBatch
+        vector<bool>&);
+
+    int mergeRebuildHelper(Node*&,             // merges a sorted run into a
+        NodeData* [], const int [], int, int,  // subtree and rebuilds it
+        vector<bool>&);                        // balanced
+
+    void recordInsert(Node*);                  // keeps optional indexes in
+                                               // step with a new node
+
+    void recordUnlinked(Node*);                // recordInsert for a node not
+                                               // yet linked into the tree,
+                                               // leaves the filter's size
+
+    void growFilter();                         // rebuilds the filter once it
+                                               // holds more keys than it was
+                                               // sized for
+
+    void recordClear();                        // resets optional indexes when
+                                               // the tree is emptied
+
+    void recordRemove(Node*);                  // drops a node about to be
+                                               // deleted from optional indexes
+
+    void afterRemove();                        // applies the balancing policy
+                                               // and filter upkeep to removals
+
+    void splitNodes(Node*, const NodeData&,    // splits a subtree along one
+        bool, Node*&, Node*&);                 // search path into keys less
+                                               // than the key (or equal, if
+                                               // inclusive) and the rest
+
+    Node* joinHelper(Node*, Node*);            // joins two subtrees whose key
+                                               // ranges are in order
+
+    void takeNodes(Node*, const BinTree&);     // adopts a split-off subtree
+                                               // and the given settings
+
+    int countNodes();                          // nodeCount, counted first if
+                                               // it is unknown
+
+    void setOperationHelper(BinTree&,          // merges the nodes of two
+        BinTree&, int);                        // trees, keeping the kinds
+                                               // of keys selected
+
+    void mergeNodesHelper(Node* [], int,       // merges two sorted node runs,
+        Node* [], int, int, vector<Node*>&);   // deleting what isn't kept
+
+    bool filterMayContain(                     // filter probe that counts
+        const NodeData&) const;                // rejects
+
+    void rebuildFilter();                      // resizes and refills the filter
+
+    void fillFilterHelper(const Node*);        // recursive helper for
+                                               // rebuildFilter
+
+    bool cacheLookup(const NodeData&, size_t&, // cache probe, also returns
+        NodeData*&) const;                     // the object's hash
+
+    void cacheStore(size_t, Node*) const;      // caches a found node
+
+    Node* indexLookup(const NodeData&) const;  // indexed node holding an
+                                               // equal object, null if none
+
+    void indexInsert(Node*);                   // adds a node to the hash
+                                               // index, growing it if needed
+
+    void indexRemove(Node*);                   // drops a node from the hash
+                                               // index, closing the gap
+
+    void resizeIndex(size_t);                  // rehashes the index into the
+                                               // given number of slots
+
+    void rebuildIndex();                       // resizes and refills the
+                                               // hash index from the tree
+
+    void fillIndexHelper(Node*);               // recursive helper for
+                                               // rebuildIndex
+
+    const Node* parentOf(const Node*) const;   // parent of a node in the
+                                               // tree, by one ordered descent
+
+    static int sortUniqueHelper(NodeData* [],  // parallel sort that deletes
+        int);                                  // duplicates, returns the
+                                               // new count
+
+    static int uniqueHelper(NodeData* [], int);// deletes adjacent duplicates
+                                               // of a sorted array, returns
+                                               // the new count
 }; 
 
-#endif
\ No newline at end of file
+//----------------------------------------------------------------------------
+// Finger
+// Remembers the path of the last hinted insert, with the key range of every
+// node on it. A Finger used with another tree, or kept across a makeEmpty or
+// a rebuild of this tree, is ignored and the search starts at the root.
+class BinTree::Finger {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: Finger holds no path, the first hinted insert starts at
+//                 the root
+Finger();
+
+private:
+    friend class BinTree;
+    struct Step {
+        Node* node;            // node on the path
+        const NodeData* low;   // keys in its subtree are greater than this,
+                               // null if unbounded
+        const NodeData* high;  // and less than this, null if unbounded
+    };
+    vector<Step> path;         // root to the last inserted node
+    const BinTree* owner;      // tree the path belongs to
+    unsigned long version;     // owner's structureVersion when path was taken
+};
+
+//----------------------------------------------------------------------------
+// Builder
+// Builds a tree from a stream of keys. Keys larger than every key so far are
+// appended in amortized O(1) and the tree stays balanced (height at most
+// log2(n) + 2) after every append, so it can be queried mid-stream. Keys out
+// of order are inserted starting from the lowest node of the right spine
+// that is still less than the key. The Builder keeps its own shape, so
+// setRebalancing does not apply to its adds.
+class BinTree::Builder {
+public:
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: The tree is emptied and is built by later calls to add
+Builder(BinTree&);
+
+//----------------------------------------------------------------------------
+// add
+// Preconditions: NodeData is dynamically allocated and comparable to those in
+//                the tree
+// Postconditions: NodeData is added and true is returned, or false if it is a
+//                 duplicate, in which case the caller still owns it. If the
+//                 tree was restructured or inserted into by anything else
+//                 since the last add, keys are inserted with a Finger from
+//                 then on
+bool add(NodeData*);
+
+private:
+    struct Pending {
+        Node* node;            // node whose right subtree is still filling
+        long long index;       // its 1-based position in the stream
+    };
+    BinTree& tree;             // tree being built
+    vector<Pending> pending;   // right spine, in decreasing height
+    Node* orphan;              // complete subtree ending at the last key
+                               // whose parent has yet to arrive
+    Node* last;                // node with the largest key
+    long long count;           // keys appended in order so far
+    unsigned long version;     // tree's structureVersion after our last add
+    unsigned long inserts;     // tree's insertVersion after our last add
+    Finger finger;             // used once the tree is restructured
+
+    void append(Node*);        // places a new largest key
+    void hang(Node*);          // puts a subtree below the spine's bottom
+};
+
+#endif
@@ -0,0 +1,44 @@
+//----------------------------------------------------------------------------
+// BITOPS.H
+// Bit scanning helpers shared by the SIMD search and scan code
+//----------------------------------------------------------------------------
+// Bit operations: the compiler builtins used on compare masks, with a
+// fallback for compilers that don't have them
+//      --allows finding the lowest set bit of a 32-bit mask
+//
+// Implementation and assumptions:
+//      --GCC and clang use __builtin_ctz, MSVC uses _BitScanForward and any
+//        other compiler a plain loop
+//      --everything is inline in this header
+//----------------------------------------------------------------------------
+
+#ifndef BITOPS_H
+#define BITOPS_H
+
+#include <cstdint>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+//----------------------------------------------------------------------------
+// lowestBit
+// Preconditions: mask is not 0
+// Postconditions: Returns the index of the lowest set bit of the mask
+inline int lowestBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    int index = 0;
+    while((mask & 1) == 0) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+#endif
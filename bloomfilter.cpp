@@ -0,0 +1,168 @@
+//----------------------------------------------------------------------------
+// BLOOMFILTER.CPP
+// Member function definitions for class BloomFilter
+//----------------------------------------------------------------------------
+// Bloom filter: a bit array that answers "definitely not present" or "maybe
+// present" for a NodeData object in a few hashed bit probes
+//
+// Assumptions:
+//      --objects can't be removed, only the whole filter can be cleared
+//      --probe positions use double hashing of NodeData::hash()
+//----------------------------------------------------------------------------
+
+#include "bloomfilter.h"
+#include <cmath>
+
+// most probes used per object no matter how many bits per key are given
+const int MAX_HASHES = 16;
+
+// derives a second, independent looking hash from the first (splitmix64)
+static uint64_t mixHash(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: Filter is disabled, isEnabled returns false
+BloomFilter::BloomFilter() {
+    bitCount = 0;
+    bitsPerKey = 0;
+    hashCount = 0;
+    keys = 0;
+    capacity = 0;
+}
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: Expected number of keys and bits per key are positive
+// Postconditions: An empty filter with room for the expected number of keys
+//                 at the given bits per key is created
+BloomFilter::BloomFilter(int expectedKeys, int perKey) {
+    capacity = (expectedKeys > 0 ? expectedKeys : 1);
+    bitsPerKey = (perKey > 0 ? perKey : 1);
+    // k = ln2 * m/n minimizes the false-positive rate
+    hashCount = static_cast<int>(bitsPerKey * 0.69314718 + 0.5);
+    if(hashCount < 1) {
+        hashCount = 1;
+    }
+    if(hashCount > MAX_HASHES) {
+        hashCount = MAX_HASHES;
+    }
+    // Round the bit array up to whole words
+    uint64_t words = (static_cast<uint64_t>(capacity) * bitsPerKey + 63) / 64;
+    bits.assign(words, 0);
+    bitCount = words * 64;
+    keys = 0;
+}
+
+//----------------------------------------------------------------------------
+// isEnabled
+// Preconditions: None
+// Postconditions: Returns true if the filter has bits, otherwise false
+bool BloomFilter::isEnabled() const {
+    return bitCount != 0;
+}
+
+//----------------------------------------------------------------------------
+// add
+// Preconditions: Filter is enabled
+// Postconditions: The bits of the NodeData argument are set, mayContain now
+//                 returns true for it
+void BloomFilter::add(const NodeData& nd) {
+    if(!isEnabled()) {
+        return;
+    }
+    uint64_t h1 = nd.hash();
+    uint64_t h2 = mixHash(h1) | 1;
+    for(int i = 0; i < hashCount; i++) {
+        uint64_t bit = (h1 + i * h2) % bitCount;
+        bits[bit / 64] |= (1ULL << (bit % 64));
+    }
+    keys++;
+}
+
+//----------------------------------------------------------------------------
+// mayContain
+// Preconditions: None
+// Postconditions: Returns false only if the NodeData argument was never added
+//                 since the last clear; always true for a disabled filter
+bool BloomFilter::mayContain(const NodeData& nd) const {
+    if(!isEnabled()) {
+        return true;
+    }
+    uint64_t h1 = nd.hash();
+    uint64_t h2 = mixHash(h1) | 1;
+    for(int i = 0; i < hashCount; i++) {
+        uint64_t bit = (h1 + i * h2) % bitCount;
+        // One unset bit proves the object was never added
+        if((bits[bit / 64] & (1ULL << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// merge
+// Preconditions: None
+// Postconditions: If both filters have the same number of bits and probes,
+//                 this filter now also holds every object of the argument and
+//                 true is returned, otherwise nothing changes and false is
+//                 returned
+bool BloomFilter::merge(const BloomFilter& other) {
+    if(!isEnabled() || bitCount != other.bitCount ||
+    hashCount != other.hashCount) {
+        return false;
+    }
+    // Same positions for the same object, so the union is a bitwise or
+    for(size_t i = 0; i < bits.size(); i++) {
+        bits[i] |= other.bits[i];
+    }
+    keys += other.keys;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// clear
+// Preconditions: None
+// Postconditions: All bits are reset, sizing and bits per key are kept
+void BloomFilter::clear() {
+    bits.assign(bits.size(), 0);
+    keys = 0;
+}
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: bits per key (0 if disabled), keys added since the last
+//                 clear, and the number of keys the filter was sized for
+int BloomFilter::getBitsPerKey() const {
+    return bitsPerKey;
+}
+
+int BloomFilter::getKeys() const {
+    return keys;
+}
+
+int BloomFilter::getCapacity() const {
+    return capacity;
+}
+
+//----------------------------------------------------------------------------
+// expectedFalsePositiveRate
+// Preconditions: None
+// Postconditions: Returns (1 - e^(-k*n/m))^k for the current number of keys,
+//                 0 if the filter is disabled or empty
+double BloomFilter::expectedFalsePositiveRate() const {
+    if(!isEnabled() || keys == 0) {
+        return 0.0;
+    }
+    double fill = 1.0 - exp(-static_cast<double>(hashCount) * keys /
+        static_cast<double>(bitCount));
+    return pow(fill, hashCount);
+}
@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------
+// BLOOMFILTER.H
+// Class for a Bloom filter over NodeData objects
+//----------------------------------------------------------------------------
+// Bloom filter: a bit array that answers "definitely not present" or "maybe
+// present" for a NodeData object in a few hashed bit probes
+//      --allows adding NodeData objects
+//      --allows testing NodeData objects for possible membership
+//      --allows estimating the false-positive rate for its current load
+//      --allows merging filters of the same size
+//
+// Implementation and assumptions:
+//      --objects can't be removed, only the whole filter can be cleared
+//      --probe positions use double hashing of NodeData::hash()
+//      --a default constructed filter is disabled and holds no bits
+//----------------------------------------------------------------------------
+
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include "nodedata.h"
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+class BloomFilter {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: Filter is disabled, isEnabled returns false
+BloomFilter();
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: Expected number of keys and bits per key are positive
+// Postconditions: An empty filter with room for the expected number of keys
+//                 at the given bits per key is created
+BloomFilter(int, int);
+
+//----------------------------------------------------------------------------
+// isEnabled
+// Preconditions: None
+// Postconditions: Returns true if the filter has bits, otherwise false
+bool isEnabled() const;
+
+//----------------------------------------------------------------------------
+// add
+// Preconditions: Filter is enabled
+// Postconditions: The bits of the NodeData argument are set, mayContain now
+//                 returns true for it
+void add(const NodeData&);
+
+//----------------------------------------------------------------------------
+// mayContain
+// Preconditions: None
+// Postconditions: Returns false only if the NodeData argument was never added
+//                 since the last clear; always true for a disabled filter
+bool mayContain(const NodeData&) const;
+
+//----------------------------------------------------------------------------
+// merge
+// Preconditions: None
+// Postconditions: If both filters have the same number of bits and probes,
+//                 this filter now also holds every object of the argument and
+//                 true is returned, otherwise nothing changes and false is
+//                 returned
+bool merge(const BloomFilter&);
+
+//----------------------------------------------------------------------------
+// clear
+// Preconditions: None
+// Postconditions: All bits are reset, sizing and bits per key are kept
+void clear();
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: bits per key (0 if disabled), keys added since the last
+//                 clear, and the number of keys the filter was sized for
+int getBitsPerKey() const;
+int getKeys() const;
+int getCapacity() const;
+
+//----------------------------------------------------------------------------
+// expectedFalsePositiveRate
+// Preconditions: None
+// Postconditions: Returns (1 - e^(-k*n/m))^k for the current number of keys,
+//                 0 if the filter is disabled or empty
+double expectedFalsePositiveRate() const;
+
+private:
+    vector<uint64_t> bits;   // the bit array, 64 bits per word
+    uint64_t bitCount;       // number of usable bits
+    int bitsPerKey;          // bits budgeted per expected key
+    int hashCount;           // probes per object
+    int keys;                // objects added since last clear
+    int capacity;            // objects the filter was sized for
+};
+
+#endif
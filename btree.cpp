@@ -0,0 +1,529 @@
+//----------------------------------------------------------------------------
+// BTREE.CPP
+// Member function definitions for class BTree
+//----------------------------------------------------------------------------
+// B-tree: stores NodeData objects in wide nodes, up to 7 per node with 8
+// children, behind the same interface as BinTree
+//
+// Assumptions:
+//      --user will pass pointers to NodeData objects to add nodes to the tree
+//      --array passed to arrayToBSTree() is already sorted beforehand
+//      --getSibling, getParent, displaySideways and == work on the logical
+//        binary view, the balanced binary tree arrayToBSTree would build,
+//        not on the insert-order shape a BinTree would have
+//----------------------------------------------------------------------------
+
+#include "btree.h"
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// assumed array size for bstreeToArray and arrayToBSTree, as in BinTree
+const int ARRAY_SIZE = 100;
+
+//----------------------------------------------------------------------------
+// operator<<
+// Preconditions: None
+// Postconditions: Nothing outputted if tree is empty, otherwise each NodeData
+//                 object of the tree is put into the ostream in sorted order
+ostream& operator<<(ostream& os, const BTree& bTree) {
+    bTree.inorderHelper(bTree.root, os);
+    os << endl;
+    return os;
+}
+
+void BTree::inorderHelper(const Node* curPtr, ostream& os) const {
+    // Base case, node doesn't exist
+    if(curPtr == nullptr) {
+        return;
+    }
+    // Every object comes after the child to its left
+    for(int i = 0; i < curPtr->count; i++) {
+        inorderHelper(curPtr->child[i], os);
+        os << *curPtr->data[i] << " ";
+    }
+    inorderHelper(curPtr->child[curPtr->count], os);
+}
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: Empty tree is created
+BTree::BTree() {
+    root = nullptr;
+}
+
+//----------------------------------------------------------------------------
+// Copy constructor
+// Preconditions: None
+// Postconditions: A deep copy of the BTree argument is created
+BTree::BTree(const BTree& otherTree) {
+    root = copyHelper(otherTree.root);
+}
+
+BTree::Node* BTree::copyHelper(const Node* otherNode) const {
+    // Base case, node doesn't exist
+    if(otherNode == nullptr) {
+        return nullptr;
+    }
+    Node* ptr = newNode();
+    ptr->count = otherNode->count;
+    ptr->size = otherNode->size;
+    for(int i = 0; i < otherNode->count; i++) {
+        ptr->prefix[i] = otherNode->prefix[i];
+        ptr->data[i] = new NodeData(*otherNode->data[i]);
+    }
+    for(int i = 0; i <= otherNode->count; i++) {
+        ptr->child[i] = copyHelper(otherNode->child[i]);
+    }
+    return ptr;
+}
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: Every node and NodeData object is deleted
+BTree::~BTree() {
+    makeEmpty();
+}
+
+//----------------------------------------------------------------------------
+// isEmpty
+// Preconditions: None
+// Postconditions: Returns true if the tree is empty, otherwise false
+bool BTree::isEmpty() const {
+    return root == nullptr;
+}
+
+//----------------------------------------------------------------------------
+// makeEmpty
+// Preconditions: None
+// Postconditions: Every node and NodeData object is deleted
+void BTree::makeEmpty() {
+    makeEmptyHelper(root);
+}
+
+void BTree::makeEmptyHelper(Node*& treeNode) {
+    // Base case, node doesn't exist so terminate
+    if(treeNode == nullptr) {
+        return;
+    }
+    for(int i = 0; i <= treeNode->count; i++) {
+        makeEmptyHelper(treeNode->child[i]);
+    }
+    for(int i = 0; i < treeNode->count; i++) {
+        delete treeNode->data[i];
+    }
+    delete treeNode;
+    treeNode = nullptr;
+}
+
+//----------------------------------------------------------------------------
+// operator=
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it becomes a deep
+//                 copy of the BTree argument
+BTree& BTree::operator=(const BTree& otherTree) {
+    // Self-assignment check
+    if(this != &otherTree) {
+        makeEmpty();
+        root = copyHelper(otherTree.root);
+    }
+    return *this;
+}
+
+//----------------------------------------------------------------------------
+// operator== and operator!=
+// Preconditions: None
+// Postconditions: Trees are equal if they hold equal objects; their logical
+//                 binary views then have the same shape too
+bool BTree::operator==(const BTree& otherTree) const {
+    int size = (root != nullptr ? root->size : 0);
+    int otherSize = (otherTree.root != nullptr ? otherTree.root->size : 0);
+    if(size != otherSize) {
+        return false;
+    }
+    for(int i = 0; i < size; i++) {
+        if(*select(i) != *otherTree.select(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BTree::operator!=(const BTree& otherTree) const {
+    return !(*this == otherTree);
+}
+
+//----------------------------------------------------------------------------
+// insert
+// Preconditions: NodeData argument is dynamically allocated
+// Postconditions: If an equal object isn't already in the tree, the object is
+//                 added and true is returned, otherwise false is returned and
+//                 the caller still owns the object
+bool BTree::insert(NodeData* dataptr) {
+    if(dataptr == nullptr) {
+        return false;
+    }
+    if(root == nullptr) {
+        root = newNode();
+    }
+    // A full root is split first, which is the only way the tree grows
+    if(root->count == MAX_KEYS) {
+        Node* ptr = newNode();
+        ptr->child[0] = root;
+        ptr->size = root->size;
+        root = ptr;
+        splitChild(root, 0);
+    }
+    uint64_t prefix = dataptr->prefix();
+    Node* cur = root;
+    for(;;) {
+        cur->size++;
+        int i = searchNode(cur, prefix, *dataptr);
+        if(i < cur->count && cur->prefix[i] == prefix &&
+        *cur->data[i] == *dataptr) {
+            undoSizes(cur, prefix, *dataptr);
+            return false;
+        }
+        // Leaf: make room at the slot and store the object
+        if(cur->child[0] == nullptr) {
+            for(int j = cur->count; j > i; j--) {
+                cur->prefix[j] = cur->prefix[j - 1];
+                cur->data[j] = cur->data[j - 1];
+            }
+            cur->prefix[i] = prefix;
+            cur->data[i] = dataptr;
+            cur->count++;
+            return true;
+        }
+        // Split a full child before entering it so there is always room
+        // for the object it may pass up
+        if(cur->child[i]->count == MAX_KEYS) {
+            splitChild(cur, i);
+            // The object moved up may be the one being inserted
+            if(cur->prefix[i] == prefix && *cur->data[i] == *dataptr) {
+                undoSizes(cur, prefix, *dataptr);
+                return false;
+            }
+            if(cur->prefix[i] < prefix || (cur->prefix[i] == prefix &&
+            *cur->data[i] < *dataptr)) {
+                i++;
+            }
+        }
+        cur = cur->child[i];
+    }
+}
+
+void BTree::undoSizes(Node* found, uint64_t prefix, const NodeData& key) {
+    // Full nodes split on the way down stay split, only the counts added
+    // for the object along its search path are taken back
+    Node* cur = root;
+    while(cur != found) {
+        cur->size--;
+        cur = cur->child[searchNode(cur, prefix, key)];
+    }
+    found->size--;
+}
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: second NodeData argument is unallocated and is expected to be
+//                assigned to the found object
+// Postconditions: If the 1st argument is found, the pointer argument points
+//                 at the tree's object and true is returned, otherwise false
+bool BTree::retrieve(const NodeData& toFind, NodeData*& toReturn) const {
+    uint64_t prefix = toFind.prefix();
+    const Node* cur = root;
+    while(cur != nullptr) {
+        int i = searchNode(cur, prefix, toFind);
+        if(i < cur->count && cur->prefix[i] == prefix &&
+        *cur->data[i] == toFind) {
+            toReturn = cur->data[i];
+            return true;
+        }
+        cur = cur->child[i];
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// getSibling
+// Preconditions: None
+// Postconditions: true returned if the first NodeData argument exists in the
+//                 tree AND its node has a sibling in the logical binary view,
+//                 with the sibling's data copied into the 2nd argument,
+//                 otherwise false is returned
+bool BTree::getSibling(const NodeData& toFind, NodeData& toReturn) const {
+    int parent;
+    int sibling;
+    if(!logicalHelper(toFind, parent, sibling) || sibling < 0) {
+        return false;
+    }
+    toReturn = *select(sibling);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// getParent
+// Preconditions: None
+// Postconditions: true returned if the first NodeData argument exists in the
+//                 tree AND its node has a parent in the logical binary view,
+//                 with the parent's data copied into the 2nd argument,
+//                 otherwise false is returned
+bool BTree::getParent(const NodeData& toFind, NodeData& toReturn) const {
+    int parent;
+    int sibling;
+    if(!logicalHelper(toFind, parent, sibling) || parent < 0) {
+        return false;
+    }
+    toReturn = *select(parent);
+    return true;
+}
+
+bool BTree::logicalHelper(const NodeData& toFind, int& parent,
+int& sibling) const {
+    int target = rank(toFind);
+    if(target < 0) {
+        return false;
+    }
+    // Walk the balanced binary tree over sorted positions, the same middle
+    // split arrayToBSTree uses, until the target's position is the root
+    int low = 0;
+    int high = root->size - 1;
+    parent = -1;
+    sibling = -1;
+    for(;;) {
+        int mid = (low + high) / 2;
+        if(mid == target) {
+            return true;
+        }
+        parent = mid;
+        int siblingLow = low;
+        int siblingHigh = high;
+        if(target < mid) {
+            siblingLow = mid + 1;
+            high = mid - 1;
+        }
+        else {
+            siblingHigh = mid - 1;
+            low = mid + 1;
+        }
+        sibling = (siblingLow <= siblingHigh ? (siblingLow + siblingHigh) / 2
+            : -1);
+    }
+}
+
+//----------------------------------------------------------------------------
+// displaySideways
+// Preconditions: None
+// Postconditions: Displays the logical binary view as though you are viewing
+//                 it from the side, outputs nothing if tree is empty
+void BTree::displaySideways() const {
+    if(root != nullptr) {
+        sidewaysHelper(0, root->size - 1, 0);
+    }
+}
+
+void BTree::sidewaysHelper(int low, int high, int level) const {
+    if(low <= high) {
+        int mid = (low + high) / 2;
+        level++;
+        sidewaysHelper(mid + 1, high, level);
+
+        // indent for readability, same number of spaces per depth level
+        for(int i = level; i >= 0; i--) {
+            cout << "      ";
+        }
+
+        cout << *select(mid) << endl;        // display information of object
+        sidewaysHelper(low, mid - 1, level);
+    }
+}
+
+//----------------------------------------------------------------------------
+// bstreeToArray
+// Preconditions: Array passed as argument is a statically allocated array of
+//                100 nullptr elements
+// Postconditions: Objects from the tree are placed into the array in sorted
+//                 order and tree is then emptied
+void BTree::bstreeToArray(NodeData* dataPtrs[]) {
+    int index = 0;
+    toArrayHelper(root, dataPtrs, index);
+    // Moved objects were unhooked, so this only deletes the nodes
+    makeEmpty();
+}
+
+void BTree::toArrayHelper(Node* curPtr, NodeData* dataPtrs[], int& index) {
+    // Base case, node doesn't exist
+    if(curPtr == nullptr) {
+        return;
+    }
+    for(int i = 0; i < curPtr->count; i++) {
+        toArrayHelper(curPtr->child[i], dataPtrs, index);
+        // Objects past the assumed array size stay and are deleted
+        if(index < ARRAY_SIZE) {
+            dataPtrs[index++] = curPtr->data[i];
+            curPtr->data[i] = nullptr;
+        }
+    }
+    toArrayHelper(curPtr->child[curPtr->count], dataPtrs, index);
+}
+
+//----------------------------------------------------------------------------
+// arrayToBSTree
+// Preconditions: Array passed as argument is already sorted beforehand, and is
+//                a statically allocated array of 100 elements originally
+//                initalized to nullptr and then filled from index 0
+// Postconditions: The tree is rebuilt from the array and every index of the
+//                 array is set to nullptr
+void BTree::arrayToBSTree(NodeData* dataPtrs[]) {
+    makeEmpty();
+    for(int i = 0; i < ARRAY_SIZE && dataPtrs[i] != nullptr; i++) {
+        if(!insert(dataPtrs[i])) {
+            delete dataPtrs[i];                // duplicate, not inserted
+        }
+        dataPtrs[i] = nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------
+// getHeight
+// Preconditions: None
+// Postconditions: Returns the number of node levels, 0 for an empty tree
+int BTree::getHeight() const {
+    // Every leaf is at the same depth, so the leftmost path is enough
+    int height = 0;
+    for(const Node* cur = root; cur != nullptr; cur = cur->child[0]) {
+        height++;
+    }
+    return height;
+}
+
+void* BTree::Node::operator new(size_t bytes) {
+    void* ptr = nullptr;
+#ifdef _WIN32
+    ptr = _aligned_malloc(bytes, alignof(Node));
+#else
+    if(posix_memalign(&ptr, alignof(Node), bytes) != 0) {
+        ptr = nullptr;
+    }
+#endif
+    if(ptr == nullptr) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+void BTree::Node::operator delete(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+BTree::Node* BTree::newNode() const {
+    // The counts and prefixes must fill exactly the first cache line
+    static_assert(offsetof(Node, data) == 64, "node header must be 64 bytes");
+    Node* ptr = new Node;
+    ptr->count = 0;
+    ptr->size = 0;
+    for(int i = 0; i < MAX_KEYS; i++) {
+        ptr->prefix[i] = 0;
+        ptr->data[i] = nullptr;
+    }
+    for(int i = 0; i <= MAX_KEYS; i++) {
+        ptr->child[i] = nullptr;
+    }
+    return ptr;
+}
+
+int BTree::searchNode(const Node* curPtr, uint64_t prefix,
+const NodeData& toFind) const {
+    // The prefixes share one cache line, so most slots are passed on an
+    // integer compare and only equal prefixes look at the objects
+    int i = 0;
+    while(i < curPtr->count && (curPtr->prefix[i] < prefix ||
+    (curPtr->prefix[i] == prefix && *curPtr->data[i] < toFind))) {
+        i++;
+    }
+    return i;
+}
+
+void BTree::splitChild(Node* parent, int index) {
+    Node* full = parent->child[index];
+    Node* right = newNode();
+    // The upper t - 1 objects and their t children move to the new node
+    right->count = MIN_DEGREE - 1;
+    for(int i = 0; i < MIN_DEGREE - 1; i++) {
+        right->prefix[i] = full->prefix[i + MIN_DEGREE];
+        right->data[i] = full->data[i + MIN_DEGREE];
+        full->data[i + MIN_DEGREE] = nullptr;
+    }
+    right->size = right->count;
+    for(int i = 0; i < MIN_DEGREE; i++) {
+        right->child[i] = full->child[i + MIN_DEGREE];
+        full->child[i + MIN_DEGREE] = nullptr;
+        if(right->child[i] != nullptr) {
+            right->size += right->child[i]->size;
+        }
+    }
+    full->count = MIN_DEGREE - 1;
+    full->size -= right->size + 1;
+    // The middle object moves up between the two halves
+    for(int i = parent->count; i > index; i--) {
+        parent->prefix[i] = parent->prefix[i - 1];
+        parent->data[i] = parent->data[i - 1];
+        parent->child[i + 1] = parent->child[i];
+    }
+    parent->prefix[index] = full->prefix[MIN_DEGREE - 1];
+    parent->data[index] = full->data[MIN_DEGREE - 1];
+    full->data[MIN_DEGREE - 1] = nullptr;
+    parent->child[index + 1] = right;
+    parent->count++;
+}
+
+const NodeData* BTree::select(int position) const {
+    const Node* cur = root;
+    while(cur != nullptr) {
+        // Skip whole children and objects until the position falls inside
+        // a child or on an object of this node
+        int i = 0;
+        for(;;) {
+            int left = (cur->child[i] != nullptr ? cur->child[i]->size : 0);
+            if(position < left || i == cur->count) {
+                break;
+            }
+            position -= left;
+            if(position == 0) {
+                return cur->data[i];
+            }
+            position--;
+            i++;
+        }
+        cur = cur->child[i];
+    }
+    return nullptr;
+}
+
+int BTree::rank(const NodeData& toFind) const {
+    uint64_t prefix = toFind.prefix();
+    int before = 0;
+    const Node* cur = root;
+    while(cur != nullptr) {
+        int i = searchNode(cur, prefix, toFind);
+        // Everything in the children and objects left of the slot is smaller
+        for(int j = 0; j < i; j++) {
+            before += 1 + (cur->child[j] != nullptr ? cur->child[j]->size : 0);
+        }
+        if(i < cur->count && *cur->data[i] == toFind) {
+            return before + (cur->child[i] != nullptr ? cur->child[i]->size :
+                0);
+        }
+        cur = cur->child[i];
+    }
+    return -1;
+}
@@ -0,0 +1,211 @@
+//----------------------------------------------------------------------------
+// BTREE.H
+// Class for a B-tree (holds NodeData objects) with the BinTree interface
+//----------------------------------------------------------------------------
+// B-tree: stores NodeData objects in wide nodes, up to 7 per node with 8
+// children, so a retrieve on a multi-million key tree visits a handful of
+// nodes instead of 20+ binary nodes. The public interface matches BinTree
+// so either engine can be used by the same callers:
+//      --allows the retrieval of sibling nodes
+//      --allows the retrieval of parent nodes
+//      --allows the outputting of a B-tree to an Array
+//      --allows the building of a B-tree from a sorted Array
+//
+// Implementation and assumptions:
+//      --user will pass pointers to NodeData objects to add nodes to the tree
+//      --array passed to arrayToBSTree() is already sorted beforehand
+//      --for <<, tree outputs data in each node followed by a space
+//      --nodes are 64-byte aligned and their first cache line holds the
+//        counts and the 8-byte prefixes of their objects, so a node is
+//        searched on integers and only objects sharing a prefix are compared
+//        in full
+//      --getSibling, getParent, displaySideways and == work on the logical
+//        binary view: the perfectly balanced binary tree over the sorted
+//        objects that arrayToBSTree would build. For a BinTree built by
+//        insert, whose shape follows the insert order, these answer
+//        differently, so a driver like lab2 prints different results when
+//        BTree is swapped in; only the shape-free operations agree
+//----------------------------------------------------------------------------
+
+#ifndef BTREE_H
+#define BTREE_H
+
+#include "nodedata.h"
+#include <cstddef>
+#include <cstdint>
+using namespace std;
+
+class BTree {
+//----------------------------------------------------------------------------
+// operator<<
+// Preconditions: None
+// Postconditions: Nothing outputted if tree is empty, otherwise each NodeData
+//                 object of the tree is put into the ostream in sorted order
+friend ostream &operator<<(ostream&, const BTree&);
+
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: Empty tree is created
+BTree();
+
+//----------------------------------------------------------------------------
+// Copy constructor
+// Preconditions: None
+// Postconditions: A deep copy of the BTree argument is created
+BTree(const BTree&);
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: Every node and NodeData object is deleted
+~BTree();
+
+//----------------------------------------------------------------------------
+// isEmpty
+// Preconditions: None
+// Postconditions: Returns true if the tree is empty, otherwise false
+bool isEmpty() const;
+
+//----------------------------------------------------------------------------
+// makeEmpty
+// Preconditions: None
+// Postconditions: Every node and NodeData object is deleted
+void makeEmpty();
+
+//----------------------------------------------------------------------------
+// operator=
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it becomes a deep
+//                 copy of the BTree argument
+BTree& operator=(const BTree&);
+
+//----------------------------------------------------------------------------
+// operator== and operator!=
+// Preconditions: None
+// Postconditions: Trees are equal if they hold equal objects; their logical
+//                 binary views then have the same shape too
+bool operator==(const BTree&) const;
+bool operator!=(const BTree&) const;
+
+//----------------------------------------------------------------------------
+// insert
+// Preconditions: NodeData argument is dynamically allocated
+// Postconditions: If an equal object isn't already in the tree, the object is
+//                 added and true is returned, otherwise false is returned and
+//                 the caller still owns the object
+bool insert(NodeData*);
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: second NodeData argument is unallocated and is expected to be
+//                assigned to the found object
+// Postconditions: If the 1st argument is found, the pointer argument points
+//                 at the tree's object and true is returned, otherwise false
+bool retrieve(const NodeData&, NodeData*&) const;
+
+//----------------------------------------------------------------------------
+// getSibling
+// Preconditions: None
+// Postconditions: true returned if the first NodeData argument exists in the
+//                 tree AND its node has a sibling in the logical binary view,
+//                 with the sibling's data copied into the 2nd argument,
+//                 otherwise false is returned
+bool getSibling(const NodeData&, NodeData&) const;
+
+//----------------------------------------------------------------------------
+// getParent
+// Preconditions: None
+// Postconditions: true returned if the first NodeData argument exists in the
+//                 tree AND its node has a parent in the logical binary view,
+//                 with the parent's data copied into the 2nd argument,
+//                 otherwise false is returned
+bool getParent(const NodeData&, NodeData&) const;
+
+//----------------------------------------------------------------------------
+// displaySideways
+// Preconditions: None
+// Postconditions: Displays the logical binary view as though you are viewing
+//                 it from the side, outputs nothing if tree is empty
+void displaySideways() const;
+
+//----------------------------------------------------------------------------
+// bstreeToArray
+// Preconditions: Array passed as argument is a statically allocated array of
+//                100 nullptr elements
+// Postconditions: Objects from the tree are placed into the array in sorted
+//                 order and tree is then emptied
+void bstreeToArray(NodeData* []);
+
+//----------------------------------------------------------------------------
+// arrayToBSTree
+// Preconditions: Array passed as argument is already sorted beforehand, and is
+//                a statically allocated array of 100 elements originally
+//                initalized to nullptr and then filled from index 0
+// Postconditions: The tree is rebuilt from the array and every index of the
+//                 array is set to nullptr
+void arrayToBSTree(NodeData* []);
+
+//----------------------------------------------------------------------------
+// getHeight
+// Preconditions: None
+// Postconditions: Returns the number of node levels, 0 for an empty tree
+int getHeight() const;
+
+private:
+    static const int MIN_DEGREE = 4;                   // t: every node but
+                                                       // the root has at
+                                                       // least t - 1 objects
+    static const int MAX_KEYS = 2 * MIN_DEGREE - 1;    // a full node
+
+    struct alignas(64) Node {
+        int count;                      // objects in this node
+        int size;                       // objects in this subtree
+        uint64_t prefix[MAX_KEYS];      // NodeData::prefix() of each object
+        NodeData* data[MAX_KEYS];       // objects in sorted order
+        Node* child[MAX_KEYS + 1];      // child[i] holds objects before
+                                        // data[i], all null in a leaf
+
+        static void* operator new(size_t);     // aligned storage, plain new
+        static void operator delete(void*);    // only promises 16 bytes
+    };
+
+    Node* root;   // root of the tree
+
+    Node* newNode() const;                     // empty leaf
+
+    Node* copyHelper(const Node*) const;       // recursive helper for copy
+                                               // constructor and operator=
+
+    void makeEmptyHelper(Node*&);              // recursive helper for makeEmpty
+
+    int searchNode(const Node*, uint64_t,      // first slot not less than the
+        const NodeData&) const;                // object, by prefix first
+
+    void splitChild(Node*, int);               // splits a full child in two
+                                               // around its middle object
+
+    void undoSizes(Node*, uint64_t,            // takes back the subtree sizes
+        const NodeData&);                      // a duplicate insert counted
+                                               // down to the node holding it
+
+    const NodeData* select(int) const;         // object at a sorted position
+
+    int rank(const NodeData&) const;           // sorted position of an object,
+                                               // -1 if it isn't in the tree
+
+    bool logicalHelper(const NodeData&,        // parent and sibling positions
+        int&, int&) const;                     // in the logical binary view
+
+    void inorderHelper(const Node*,            // recursive helper for
+        ostream&) const;                       // operator<<
+
+    void sidewaysHelper(int, int, int) const;  // recursive helper for
+                                               // displaySideways
+
+    void toArrayHelper(Node*, NodeData* [],    // recursive helper for
+        int&);                                 // bstreeToArray
+};
+
+#endif
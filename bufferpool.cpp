@@ -0,0 +1,245 @@
+//----------------------------------------------------------------------------
+// BUFFERPOOL.CPP
+// Member function definitions for class BufferPool
+//----------------------------------------------------------------------------
+// Buffer pool: keeps up to a set number of 4 KB pages of one file in memory
+// and writes changed pages back when they are evicted or flushed
+//
+// Assumptions:
+//      --eviction uses the clock algorithm
+//      --a page pointer returned by fetch is only valid until the next call
+//        to fetch or allocate
+//----------------------------------------------------------------------------
+
+#include "bufferpool.h"
+#include <cstring>
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed pool is created, open must be called before use
+BufferPool::BufferPool() {
+    hand = 0;
+    pageCount = 0;
+    hits = misses = reads = writes = evictions = 0;
+}
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: Changed pages are written back and the file is closed
+BufferPool::~BufferPool() {
+    close();
+}
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: Number of frames is positive
+// Postconditions: Any file already open is closed first. The file is opened
+//                 (emptied or created if the bool argument is true) with room
+//                 for the given number of pages in memory. Returns false if
+//                 the file can't be opened
+bool BufferPool::open(const string& path, int frameCount, bool create) {
+    close();
+    ios::openmode mode = ios::in | ios::out | ios::binary;
+    if(create) {
+        mode |= ios::trunc;
+    }
+    file.open(path.c_str(), mode);
+    if(!file.is_open()) {
+        return false;
+    }
+    file.seekg(0, ios::end);
+    pageCount = static_cast<uint32_t>(static_cast<long long>(file.tellg()) /
+        PAGE_SIZE);
+    // All page memory is allocated up front, this is the memory cap
+    frames.assign(frameCount > 0 ? frameCount : 1, Frame());
+    for(Frame& frame : frames) {
+        frame.page = 0;
+        frame.used = false;
+        frame.dirty = false;
+        frame.referenced = false;
+        frame.bytes.assign(PAGE_SIZE, 0);
+    }
+    lookup.clear();
+    hand = 0;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: Changed pages are written back and the file is closed
+void BufferPool::close() {
+    if(!file.is_open()) {
+        return;
+    }
+    flush();
+    file.close();
+    frames.clear();
+    lookup.clear();
+    pageCount = 0;
+}
+
+//----------------------------------------------------------------------------
+// isOpen
+// Preconditions: None
+// Postconditions: Returns true if a file is open, otherwise false
+bool BufferPool::isOpen() const {
+    return file.is_open();
+}
+
+//----------------------------------------------------------------------------
+// fetch
+// Preconditions: Page number is less than getPageCount
+// Postconditions: Returns the page's bytes in memory, loading it if needed,
+//                 or nullptr on a file error. If the bool argument is true
+//                 the page will be written back before it is evicted
+char* BufferPool::fetch(uint32_t page, bool dirty) {
+    if(!isOpen() || page >= pageCount) {
+        return nullptr;
+    }
+    int slot;
+    unordered_map<uint32_t, int>::const_iterator found = lookup.find(page);
+    if(found != lookup.end()) {
+        hits++;
+        slot = found->second;
+        frames[slot].referenced = true;
+    }
+    else {
+        misses++;
+        slot = loadFrame(page, false);
+        if(slot < 0) {
+            return nullptr;
+        }
+    }
+    if(dirty) {
+        frames[slot].dirty = true;
+    }
+    return frames[slot].bytes.data();
+}
+
+//----------------------------------------------------------------------------
+// allocate
+// Preconditions: None
+// Postconditions: A zero-filled page is added at the end of the file and its
+//                 number is returned, 0 on a file error
+uint32_t BufferPool::allocate() {
+    if(!isOpen()) {
+        return 0;
+    }
+    // The page only reaches the file when it is written back, until then
+    // the pool holds the only copy so it starts out dirty
+    uint32_t page = pageCount++;
+    int slot = loadFrame(page, true);
+    if(slot < 0) {
+        pageCount--;
+        return 0;
+    }
+    frames[slot].dirty = true;
+    return page;
+}
+
+//----------------------------------------------------------------------------
+// flush
+// Preconditions: None
+// Postconditions: Every changed page is written back, returns false on a
+//                 file error
+bool BufferPool::flush() {
+    bool ok = true;
+    for(Frame& frame : frames) {
+        if(frame.used && frame.dirty && !writeFrame(frame)) {
+            ok = false;
+        }
+    }
+    file.flush();
+    return ok && !file.fail();
+}
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: pages in the file, and the pool's counters
+uint32_t BufferPool::getPageCount() const {
+    return pageCount;
+}
+
+BufferPool::Stats BufferPool::getStats() const {
+    Stats stats;
+    stats.frames = static_cast<int>(frames.size());
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.reads = reads;
+    stats.writes = writes;
+    stats.evictions = evictions;
+    long long fetches = hits + misses;
+    stats.hitRate = (fetches > 0 ? static_cast<double>(hits) / fetches : 0.0);
+    return stats;
+}
+
+//----------------------------------------------------------------------------
+// resetStats
+// Preconditions: None
+// Postconditions: hit, miss and transfer counters are set to zero
+void BufferPool::resetStats() {
+    hits = misses = reads = writes = evictions = 0;
+}
+
+int BufferPool::loadFrame(uint32_t page, bool zero) {
+    int slot = victimFrame();
+    Frame& frame = frames[slot];
+    // A changed page has to reach the file before its frame is reused
+    if(frame.used) {
+        if(frame.dirty && !writeFrame(frame)) {
+            return -1;
+        }
+        lookup.erase(frame.page);
+        frame.used = false;
+        evictions++;
+    }
+    if(zero) {
+        memset(frame.bytes.data(), 0, PAGE_SIZE);
+    }
+    else {
+        file.seekg(static_cast<streamoff>(page) * PAGE_SIZE);
+        file.read(frame.bytes.data(), PAGE_SIZE);
+        // A page allocated past the end but never written reads as zeros
+        streamsize got = file.gcount();
+        if(got < PAGE_SIZE) {
+            memset(frame.bytes.data() + got, 0, PAGE_SIZE - got);
+        }
+        file.clear();
+        reads++;
+    }
+    frame.page = page;
+    frame.used = true;
+    frame.dirty = false;
+    frame.referenced = true;
+    lookup[page] = slot;
+    return slot;
+}
+
+int BufferPool::victimFrame() {
+    // Sweep, giving every referenced frame a second chance; after one full
+    // turn every bit is clear, so this ends within two turns
+    for(;;) {
+        Frame& frame = frames[hand];
+        int slot = hand;
+        hand = (hand + 1) % static_cast<int>(frames.size());
+        if(!frame.used || !frame.referenced) {
+            return slot;
+        }
+        frame.referenced = false;
+    }
+}
+
+bool BufferPool::writeFrame(Frame& frame) {
+    file.seekp(static_cast<streamoff>(frame.page) * PAGE_SIZE);
+    file.write(frame.bytes.data(), PAGE_SIZE);
+    if(file.fail()) {
+        file.clear();
+        return false;
+    }
+    frame.dirty = false;
+    writes++;
+    return true;
+}
@@ -0,0 +1,148 @@
+//----------------------------------------------------------------------------
+// BUFFERPOOL.H
+// Class for a fixed-size cache of file pages
+//----------------------------------------------------------------------------
+// Buffer pool: keeps up to a set number of 4 KB pages of one file in memory
+// and writes changed pages back when they are evicted or flushed, so a
+// structure much larger than RAM can be worked on through a capped amount of
+// memory
+//      --allows reading and changing pages by number
+//      --allows appending new pages to the file
+//      --allows reporting hits, misses and page transfers
+//
+// Implementation and assumptions:
+//      --eviction uses the clock algorithm: every frame has a reference bit
+//        that a hit sets and the sweeping hand clears, and the first frame
+//        found with the bit clear is reused
+//      --a page pointer returned by fetch is only valid until the next call
+//        to fetch or allocate, callers copy what they need out first
+//      --not synchronized between threads
+//----------------------------------------------------------------------------
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+class BufferPool {
+public:
+static const int PAGE_SIZE = 4096;   // bytes per page, in memory and on disk
+
+//----------------------------------------------------------------------------
+// Stats
+// Counters reported by getStats
+struct Stats {
+    int frames;              // pages the pool can hold
+    long long hits;          // fetches answered from memory
+    long long misses;        // fetches that had to load a page
+    long long reads;         // pages read from the file
+    long long writes;        // pages written to the file
+    long long evictions;     // pages dropped to make room
+    double hitRate;          // hits over all fetches, 0 before any
+};
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed pool is created, open must be called before use
+BufferPool();
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: Changed pages are written back and the file is closed
+~BufferPool();
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: Number of frames is positive
+// Postconditions: Any file already open is closed first. The file is opened
+//                 (emptied or created if the bool argument is true) with room
+//                 for the given number of pages in memory. Returns false if
+//                 the file can't be opened
+bool open(const string&, int, bool);
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: Changed pages are written back and the file is closed
+void close();
+
+//----------------------------------------------------------------------------
+// isOpen
+// Preconditions: None
+// Postconditions: Returns true if a file is open, otherwise false
+bool isOpen() const;
+
+//----------------------------------------------------------------------------
+// fetch
+// Preconditions: Page number is less than getPageCount
+// Postconditions: Returns the page's bytes in memory, loading it if needed,
+//                 or nullptr on a file error. If the bool argument is true
+//                 the page will be written back before it is evicted
+char* fetch(uint32_t, bool);
+
+//----------------------------------------------------------------------------
+// allocate
+// Preconditions: None
+// Postconditions: A zero-filled page is added at the end of the file and its
+//                 number is returned, 0 on a file error
+uint32_t allocate();
+
+//----------------------------------------------------------------------------
+// flush
+// Preconditions: None
+// Postconditions: Every changed page is written back, returns false on a
+//                 file error
+bool flush();
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: pages in the file, and the pool's counters
+uint32_t getPageCount() const;
+Stats getStats() const;
+
+//----------------------------------------------------------------------------
+// resetStats
+// Preconditions: None
+// Postconditions: hit, miss and transfer counters are set to zero
+void resetStats();
+
+private:
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    struct Frame {
+        uint32_t page;           // page held, meaningless if not used
+        bool used;               // frame holds a page
+        bool dirty;              // page changed since it was loaded
+        bool referenced;         // clock bit, set on every hit
+        vector<char> bytes;      // the page
+    };
+
+    vector<Frame> frames;                      // fixed once opened
+    unordered_map<uint32_t, int> lookup;       // page number to frame
+    int hand;                                  // next frame the clock checks
+    fstream file;                              // the paged file
+    uint32_t pageCount;                        // pages in the file
+    long long hits;                            // counters for getStats
+    long long misses;
+    long long reads;
+    long long writes;
+    long long evictions;
+
+    int loadFrame(uint32_t, bool);             // frame holding a page, read
+                                               // or zero-filled, -1 on error
+
+    int victimFrame();                         // next frame to reuse, by the
+                                               // clock algorithm
+
+    bool writeFrame(Frame&);                   // writes a frame's page back
+};
+
+#endif
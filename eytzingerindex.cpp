@@ -0,0 +1,160 @@
+//----------------------------------------------------------------------------
+// EYTZINGERINDEX.CPP
+// Member function definitions for class EytzingerIndex
+//----------------------------------------------------------------------------
+// Eytzinger index: a snapshot of a BinTree laid out as a perfectly balanced
+// tree in breadth-first order in flat arrays
+//
+// Assumptions:
+//      --all keys together are less than 4 GB
+//      --the index holds its own copies, later changes to the tree are not
+//        seen until the index is built again
+//----------------------------------------------------------------------------
+
+#include "eytzingerindex.h"
+#include "prefetch.h"
+#include <algorithm>
+
+// levels below the current node whose prefixes are requested ahead; the 8
+// prefixes 3 levels down fill one 64-byte cache line
+const int PREFETCH_LEVELS = 3;
+
+// number of low 1 bits, at most the width of the argument
+static int trailingOnes(size_t value) {
+    int ones = 0;
+    while((value & 1) != 0) {
+        value >>= 1;
+        ones++;
+    }
+    return ones;
+}
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: An empty index is created
+EytzingerIndex::EytzingerIndex() {
+    prefixes.assign(1, 0);
+    offsets.assign(2, 0);
+}
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: An index holding a copy of every object in the BinTree
+//                 argument is created, the tree is unchanged
+EytzingerIndex::EytzingerIndex(const BinTree& tree) {
+    build(tree);
+}
+
+//----------------------------------------------------------------------------
+// build
+// Preconditions: None
+// Postconditions: The index's old contents are replaced by a copy of every
+//                 object in the BinTree argument
+void EytzingerIndex::build(const BinTree& tree) {
+    vector<NodeData> sorted;
+    tree.flatten(sorted);
+    size_t count = sorted.size();
+    // Find the sorted position that belongs in every breadth-first slot
+    vector<int> position(count + 1);
+    int next = 0;
+    layoutHelper(position, next, 1);
+    // Lay the blob out in slot order so a slot's offsets bracket its bytes
+    size_t total = 0;
+    for(const NodeData& nd : sorted) {
+        total += nd.getData().size();
+    }
+    prefixes.assign(count + 1, 0);
+    offsets.assign(count + 2, 0);
+    blob.clear();
+    blob.reserve(total);
+    for(size_t slot = 1; slot <= count; slot++) {
+        const string& key = sorted[position[slot]].getData();
+        prefixes[slot] = sorted[position[slot]].prefix();
+        offsets[slot] = static_cast<uint32_t>(blob.size());
+        blob += key;
+    }
+    offsets[count + 1] = static_cast<uint32_t>(blob.size());
+}
+
+void EytzingerIndex::layoutHelper(vector<int>& position, int& next,
+size_t slot) const {
+    // Base case, slot is past the last node
+    if(slot >= position.size()) {
+        return;
+    }
+    // An in-order walk of the implicit tree visits slots in key order
+    layoutHelper(position, next, 2 * slot);
+    position[slot] = next++;
+    layoutHelper(position, next, 2 * slot + 1);
+}
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: None
+// Postconditions: Returns true if the NodeData argument is in the index,
+//                 otherwise false
+bool EytzingerIndex::retrieve(const NodeData& toFind) const {
+    size_t slot = lowerBoundHelper(toFind);
+    // The first key not less than the target is the only possible match
+    if(slot == 0) {
+        return false;
+    }
+    const string& key = toFind.getData();
+    return prefixes[slot] == toFind.prefix() && blob.compare(offsets[slot],
+        offsets[slot + 1] - offsets[slot], key) == 0;
+}
+
+//----------------------------------------------------------------------------
+// lowerBound
+// Preconditions: None
+// Postconditions: If some object is not less than the 1st NodeData argument,
+//                 the first such object is copied into the 2nd and true is
+//                 returned, otherwise false is returned
+bool EytzingerIndex::lowerBound(const NodeData& toFind,
+NodeData& toReturn) const {
+    size_t slot = lowerBoundHelper(toFind);
+    if(slot == 0) {
+        return false;
+    }
+    toReturn = NodeData(blob.substr(offsets[slot],
+        offsets[slot + 1] - offsets[slot]));
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// getSize
+// Preconditions: None
+// Postconditions: Returns the number of objects in the index
+int EytzingerIndex::getSize() const {
+    return static_cast<int>(prefixes.size()) - 1;
+}
+
+size_t EytzingerIndex::lowerBoundHelper(const NodeData& toFind) const {
+    const string& key = toFind.getData();
+    uint64_t prefix = toFind.prefix();
+    size_t count = prefixes.size() - 1;
+    const uint64_t* base = prefixes.data();
+    size_t slot = 1;
+    while(slot <= count) {
+        // Descendants 3 levels down sit together, ask for them now so they
+        // arrive while the levels in between are compared; addresses past
+        // the end of the array aren't formed at all
+        size_t ahead = slot << PREFETCH_LEVELS;
+        if(ahead <= count) {
+            prefetchRead(base + ahead);
+            prefetchRead(base + min(ahead + (1 << PREFETCH_LEVELS) - 1,
+                count));
+        }
+        // Go right when the slot's key is less; equal prefixes are rare
+        // and are the only case that reads the key blob
+        bool less = base[slot] < prefix || (base[slot] == prefix &&
+            blob.compare(offsets[slot], offsets[slot + 1] - offsets[slot],
+            key) < 0);
+        slot = 2 * slot + (less ? 1 : 0);
+    }
+    // The path ends with a 1 for every right turn after the last left turn,
+    // and the node where that left turn was taken is the answer
+    return slot >> (trailingOnes(slot) + 1);
+}
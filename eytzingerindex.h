@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------
+// EYTZINGERINDEX.H
+// Class for a read-only index over NodeData objects in Eytzinger order
+//----------------------------------------------------------------------------
+// Eytzinger index: a snapshot of a BinTree laid out as a perfectly balanced
+// tree in breadth-first order in flat arrays. Node k's children are 2k and
+// 2k + 1, so a search is index arithmetic with no child pointers and the
+// nodes a few levels below can be prefetched before they are needed
+//      --allows retrieving NodeData objects
+//      --allows finding the first object not less than a NodeData object
+//
+// Implementation and assumptions:
+//      --every key's first 8 bytes are packed big-endian into one word, so
+//        most comparisons are a single integer compare; only keys sharing
+//        the first 8 bytes compare the full string in the key blob
+//      --all keys together are less than 4 GB
+//      --the index holds its own copies, later changes to the tree are not
+//        seen until the index is built again
+//----------------------------------------------------------------------------
+
+#ifndef EYTZINGERINDEX_H
+#define EYTZINGERINDEX_H
+
+#include "nodedata.h"
+#include "bintree.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+class EytzingerIndex {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: An empty index is created
+EytzingerIndex();
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: An index holding a copy of every object in the BinTree
+//                 argument is created, the tree is unchanged
+explicit EytzingerIndex(const BinTree&);
+
+//----------------------------------------------------------------------------
+// build
+// Preconditions: None
+// Postconditions: The index's old contents are replaced by a copy of every
+//                 object in the BinTree argument
+void build(const BinTree&);
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: None
+// Postconditions: Returns true if the NodeData argument is in the index,
+//                 otherwise false
+bool retrieve(const NodeData&) const;
+
+//----------------------------------------------------------------------------
+// lowerBound
+// Preconditions: None
+// Postconditions: If some object is not less than the 1st NodeData argument,
+//                 the first such object is copied into the 2nd and true is
+//                 returned, otherwise false is returned
+bool lowerBound(const NodeData&, NodeData&) const;
+
+//----------------------------------------------------------------------------
+// getSize
+// Preconditions: None
+// Postconditions: Returns the number of objects in the index
+int getSize() const;
+
+private:
+    vector<uint64_t> prefixes;   // packed key prefixes, slot 0 unused
+    vector<uint32_t> offsets;    // key k is blob[offsets[k], offsets[k + 1])
+    string blob;                 // every key, in the same order as prefixes
+
+    void layoutHelper(vector<int>&, int&,      // sorted position of every
+        size_t) const;                         // breadth-first slot
+
+    size_t lowerBoundHelper(                   // slot of the first key not
+        const NodeData&) const;                // less than the argument, 0
+                                               // if there is none
+};
+
+#endif
@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------
+// FROZENINDEX.CPP
+// Member function definitions for class FrozenIndex
+//----------------------------------------------------------------------------
+// Frozen index: a snapshot of a BinTree copied into one contiguous sorted
+// array, searched with branchless binary search for read-mostly phases
+//
+// Assumptions:
+//      --the index holds its own copies, later changes to the tree are not
+//        seen until the index is built again
+//----------------------------------------------------------------------------
+
+#include "frozenindex.h"
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: An empty index is created
+FrozenIndex::FrozenIndex() {
+}
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: An index holding a sorted copy of every object in the
+//                 BinTree argument is created, the tree is unchanged
+FrozenIndex::FrozenIndex(const BinTree& tree) {
+    build(tree);
+}
+
+//----------------------------------------------------------------------------
+// build
+// Preconditions: None
+// Postconditions: The index's old contents are replaced by a sorted copy of
+//                 every object in the BinTree argument
+void FrozenIndex::build(const BinTree& tree) {
+    // The tree's in-order walk is already sorted and free of duplicates
+    tree.flatten(keys);
+    keys.shrink_to_fit();
+}
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: None
+// Postconditions: If the NodeData argument is in the index, the pointer
+//                 argument points at the index's copy and true is returned,
+//                 otherwise it is set to nullptr and false is returned
+bool FrozenIndex::retrieve(const NodeData& toFind,
+const NodeData*& toReturn) const {
+    int pos = lowerBoundHelper(toFind);
+    // The first key not less than the target is the only possible match
+    if(pos < getSize() && keys[pos] == toFind) {
+        toReturn = &keys[pos];
+        return true;
+    }
+    toReturn = nullptr;
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// lowerBound
+// Preconditions: None
+// Postconditions: Returns a pointer to the first object not less than the
+//                 NodeData argument, nullptr if there is none
+const NodeData* FrozenIndex::lowerBound(const NodeData& toFind) const {
+    return getData(lowerBoundHelper(toFind));
+}
+
+//----------------------------------------------------------------------------
+// rank
+// Preconditions: None
+// Postconditions: Returns the number of objects less than the NodeData
+//                 argument, which is its sorted position if it is present
+int FrozenIndex::rank(const NodeData& toFind) const {
+    return lowerBoundHelper(toFind);
+}
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: number of objects in the index, and the object at a sorted
+//                 position (nullptr if the position is out of range)
+int FrozenIndex::getSize() const {
+    return static_cast<int>(keys.size());
+}
+
+const NodeData* FrozenIndex::getData(int pos) const {
+    if(pos < 0 || pos >= getSize()) {
+        return nullptr;
+    }
+    return &keys[pos];
+}
+
+int FrozenIndex::lowerBoundHelper(const NodeData& toFind) const {
+    int count = getSize();
+    if(count == 0) {
+        return 0;
+    }
+    // Halve the range every step; the comparison only picks the next base,
+    // so the compiler can use a conditional move instead of a branch and the
+    // number of steps depends on the size alone
+    const NodeData* base = keys.data();
+    while(count > 1) {
+        int half = count / 2;
+        base = (base[half] < toFind ? base + half : base);
+        count -= half;
+    }
+    return static_cast<int>(base - keys.data()) + (*base < toFind ? 1 : 0);
+}
@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------------
+// FROZENINDEX.H
+// Class for a read-only sorted index over NodeData objects
+//----------------------------------------------------------------------------
+// Frozen index: a snapshot of a BinTree copied into one contiguous sorted
+// array, searched with branchless binary search for read-mostly phases
+//      --allows retrieving NodeData objects
+//      --allows finding the first object not less than a NodeData object
+//      --allows finding the rank of a NodeData object
+//
+// Implementation and assumptions:
+//      --the index holds its own copies, later changes to the tree are not
+//        seen until the index is built again
+//      --the index can't be changed once built, only rebuilt
+//----------------------------------------------------------------------------
+
+#ifndef FROZENINDEX_H
+#define FROZENINDEX_H
+
+#include "nodedata.h"
+#include "bintree.h"
+#include <vector>
+using namespace std;
+
+class FrozenIndex {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: An empty index is created
+FrozenIndex();
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: An index holding a sorted copy of every object in the
+//                 BinTree argument is created, the tree is unchanged
+explicit FrozenIndex(const BinTree&);
+
+//----------------------------------------------------------------------------
+// build
+// Preconditions: None
+// Postconditions: The index's old contents are replaced by a sorted copy of
+//                 every object in the BinTree argument
+void build(const BinTree&);
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: None
+// Postconditions: If the NodeData argument is in the index, the pointer
+//                 argument points at the index's copy and true is returned,
+//                 otherwise it is set to nullptr and false is returned
+bool retrieve(const NodeData&, const NodeData*&) const;
+
+//----------------------------------------------------------------------------
+// lowerBound
+// Preconditions: None
+// Postconditions: Returns a pointer to the first object not less than the
+//                 NodeData argument, nullptr if there is none
+const NodeData* lowerBound(const NodeData&) const;
+
+//----------------------------------------------------------------------------
+// rank
+// Preconditions: None
+// Postconditions: Returns the number of objects less than the NodeData
+//                 argument, which is its sorted position if it is present
+int rank(const NodeData&) const;
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: number of objects in the index, and the object at a sorted
+//                 position (nullptr if the position is out of range)
+int getSize() const;
+const NodeData* getData(int) const;
+
+private:
+    vector<NodeData> keys;                     // sorted copies, no duplicates
+
+    int lowerBoundHelper(                      // position of the first key
+        const NodeData&) const;                // not less than the argument
+};
+
+#endif
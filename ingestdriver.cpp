@@ -0,0 +1,231 @@
+//----------------------------------------------------------------------------
+// INGESTDRIVER.CPP
+// Member function definitions for class IngestDriver
+//----------------------------------------------------------------------------
+// Ingest driver: lab2's data file is a sequence of independent records, one
+// line of tokens ending in "$$" per tree. The driver maps the file, cuts it
+// into chunks of whole records and hands the chunks to a pool of worker
+// threads; each worker builds every tree of its chunk and runs a caller's
+// job on it, and the jobs' output is written in file order
+//
+// Assumptions:
+//      --chunks are claimed in order, so the chunk being written is never
+//        waiting behind chunks that are not yet claimed
+//      --the calling thread does the writing while the workers run
+//----------------------------------------------------------------------------
+
+#include "ingestdriver.h"
+#include "tokenscanner.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+// bounds on the bytes aimed for per chunk, the cut moves on to the next "$$"
+const size_t MIN_CHUNK_BYTES = 1 << 16;
+const size_t MAX_CHUNK_BYTES = 1 << 20;
+
+// chunks aimed for per worker, so uneven records still spread out
+const size_t CHUNKS_PER_WORKER = 8;
+
+// chunks each worker may finish ahead of the chunk being written
+const size_t CHUNKS_AHEAD = 4;
+
+// whitespace as >> sees it in the C locale
+static bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed driver is created, open must be called before use
+IngestDriver::IngestDriver() {
+    records = 0;
+    objects = 0;
+}
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: None
+// Postconditions: The named file is mapped, returns false if it can't be
+//                 opened
+bool IngestDriver::open(const string& path) {
+    return file.open(path);
+}
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: The file is unmapped
+void IngestDriver::close() {
+    file.close();
+}
+
+//----------------------------------------------------------------------------
+// run
+// Preconditions: File is open
+// Postconditions: The job is called once per record with that record's tree
+//                 and a stream; everything the jobs write reaches the ostream
+//                 argument in record order. Uses the given number of worker
+//                 threads, or one per core if it isn't positive. Returns the
+//                 number of records
+int IngestDriver::run(const function<void(BinTree&, ostream&)>& job,
+ostream& out, int workers) {
+    records = 0;
+    objects = 0;
+    if(workers <= 0) {
+        workers = static_cast<int>(thread::hardware_concurrency());
+    }
+    if(workers <= 0) {
+        workers = 1;
+    }
+    vector<Chunk> chunks;
+    splitHelper(chunks, file.getSize() / (CHUNKS_PER_WORKER * workers));
+    size_t ahead = CHUNKS_AHEAD * static_cast<size_t>(workers);
+    // Shared state, guarded by the mutex
+    mutex lock;
+    condition_variable changed;
+    size_t claimed = 0;
+    size_t written = 0;
+    vector<string> results(chunks.size());
+    vector<int> chunkRecords(chunks.size(), 0);
+    vector<long long> chunkObjects(chunks.size(), 0);
+    vector<bool> finished(chunks.size(), false);
+
+    vector<thread> pool;
+    for(int w = 0; w < workers; w++) {
+        pool.emplace_back([&]() {
+            for(;;) {
+                size_t index;
+                {
+                    unique_lock<mutex> guard(lock);
+                    // Don't run too far ahead of the writer
+                    changed.wait(guard, [&]() {
+                        return claimed == chunks.size() ||
+                            claimed < written + ahead;
+                    });
+                    if(claimed == chunks.size()) {
+                        return;
+                    }
+                    index = claimed++;
+                }
+                string text;
+                int count = 0;
+                long long added = 0;
+                chunkHelper(chunks[index], job, text, count, added);
+                {
+                    lock_guard<mutex> guard(lock);
+                    results[index].swap(text);
+                    chunkRecords[index] = count;
+                    chunkObjects[index] = added;
+                    finished[index] = true;
+                }
+                changed.notify_all();
+            }
+        });
+    }
+    // Write every chunk's output as soon as it and all before it are done
+    for(size_t i = 0; i < chunks.size(); i++) {
+        string text;
+        {
+            unique_lock<mutex> guard(lock);
+            changed.wait(guard, [&]() { return finished[i]; });
+            text.swap(results[i]);
+            records += chunkRecords[i];
+            objects += chunkObjects[i];
+        }
+        out << text;
+        {
+            lock_guard<mutex> guard(lock);
+            written++;
+        }
+        changed.notify_all();
+    }
+    for(thread& t : pool) {
+        t.join();
+    }
+    return records;
+}
+
+void IngestDriver::splitHelper(vector<Chunk>& chunks, size_t bytes) const {
+    bytes = max(MIN_CHUNK_BYTES, min(bytes, MAX_CHUNK_BYTES));
+    size_t size = file.getSize();
+    size_t begin = 0;
+    while(begin < size) {
+        size_t target = (size - begin > bytes ? begin + bytes : size);
+        size_t end = recordEnd(target);
+        chunks.push_back(Chunk{begin, end});
+        begin = end;
+    }
+}
+
+size_t IngestDriver::recordEnd(size_t position) const {
+    const char* bytes = file.getData();
+    size_t size = file.getSize();
+    // Back up to the start of a token cut in the middle
+    while(position > 0 && position < size && !isSpace(bytes[position - 1])) {
+        position--;
+    }
+    // Walk whole tokens until one is "$$", the boundary is right after it
+    for(;;) {
+        while(position < size && isSpace(bytes[position])) {
+            position++;
+        }
+        if(position == size) {
+            return size;
+        }
+        size_t start = position;
+        while(position < size && !isSpace(bytes[position])) {
+            position++;
+        }
+        if(position - start == 2 && bytes[start] == '$' &&
+        bytes[start + 1] == '$') {
+            return position;
+        }
+    }
+}
+
+void IngestDriver::chunkHelper(const Chunk& chunk,
+const function<void(BinTree&, ostream&)>& job, string& text, int& count,
+long long& added) const {
+    const char* bytes = file.getData() + chunk.begin;
+    TokenScanner scanner;
+    int tokens = scanner.scan(bytes, chunk.end - chunk.begin);
+    const size_t* offsets = scanner.getOffsets();
+    const size_t* lengths = scanner.getLengths();
+    const vector<int>& terminators = scanner.getTerminators();
+    ostringstream out;
+    size_t next = 0;
+    int first = 0;
+    while(first < tokens) {
+        // Record runs to the next "$$", or to the end of the chunk
+        int last = (next < terminators.size() ? terminators[next++] : tokens);
+        BinTree tree;
+        for(int i = first; i < last; i++) {
+            NodeData* ptr = new NodeData(bytes + offsets[i], lengths[i]);
+            if(tree.insert(ptr)) {
+                added++;
+            }
+            else {
+                delete ptr;            // duplicate case, not inserted
+            }
+        }
+        job(tree, out);
+        count++;
+        first = last + 1;
+    }
+    text = out.str();
+}
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: records and distinct objects of the last run
+int IngestDriver::getRecords() const {
+    return records;
+}
+
+long long IngestDriver::getObjects() const {
+    return objects;
+}
@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------
+// INGESTDRIVER.H
+// Class for building and querying the trees of a data file in parallel
+//----------------------------------------------------------------------------
+// Ingest driver: lab2's data file is a sequence of independent records, one
+// line of tokens ending in "$$" per tree. The driver maps the file, cuts it
+// into chunks of whole records and hands the chunks to a pool of worker
+// threads; each worker builds every tree of its chunk and runs a caller's
+// job on it, and the jobs' output is written in file order
+//      --allows running a job on the tree of every record
+//      --allows choosing the number of worker threads
+//      --allows reading how many records and objects were processed
+//
+// Implementation and assumptions:
+//      --each record's tree is built by inserting its tokens in file order,
+//        so it has the shape buildTree would give it
+//      --a last record with no "$$" still counts; whitespace after the last
+//        "$$" is not a record
+//      --the job runs on several threads at once and must only touch the
+//        tree and the stream it is given
+//      --only a bounded number of chunks run ahead of the one being written,
+//        so output isn't held in memory for the whole file
+//----------------------------------------------------------------------------
+
+#ifndef INGESTDRIVER_H
+#define INGESTDRIVER_H
+
+#include "bintree.h"
+#include "mappedfile.h"
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+class IngestDriver {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed driver is created, open must be called before use
+IngestDriver();
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: None
+// Postconditions: The named file is mapped, returns false if it can't be
+//                 opened
+bool open(const string&);
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: The file is unmapped
+void close();
+
+//----------------------------------------------------------------------------
+// run
+// Preconditions: File is open
+// Postconditions: The job is called once per record with that record's tree
+//                 and a stream; everything the jobs write reaches the ostream
+//                 argument in record order. Uses the given number of worker
+//                 threads, or one per core if it isn't positive. Returns the
+//                 number of records
+int run(const function<void(BinTree&, ostream&)>&, ostream&, int);
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: records and distinct objects of the last run
+int getRecords() const;
+long long getObjects() const;
+
+private:
+    struct Chunk {
+        size_t begin;          // first byte, the start of a record
+        size_t end;            // byte after its last record
+    };
+
+    MappedFile file;           // the data file
+    int records;               // counters of the last run
+    long long objects;
+
+    void splitHelper(vector<Chunk>&, size_t)   // cuts the file into chunks
+        const;                                 // of about the given size
+                                               // that end after a "$$"
+
+    size_t recordEnd(size_t) const;            // first record boundary at
+                                               // or after a byte
+
+    void chunkHelper(const Chunk&,             // builds and runs the job on
+        const function<void(BinTree&,          // every record of a chunk,
+        ostream&)>&, string&, int&,            // collecting its output and
+        long long&) const;                     // counts
+};
+
+#endif
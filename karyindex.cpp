@@ -0,0 +1,264 @@
+//----------------------------------------------------------------------------
+// KARYINDEX.CPP
+// Member function definitions for class KaryIndex
+//----------------------------------------------------------------------------
+// K-ary index: a snapshot of a BinTree as a static search tree of 64-byte
+// nodes holding 16 key prefixes each
+//
+// Assumptions:
+//      --uses SSE2 where available, otherwise a scalar loop
+//----------------------------------------------------------------------------
+
+#include "karyindex.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define KARY_SSE2 1
+#endif
+
+// prefixes per node, 16 four-byte prefixes fill one 64-byte cache line
+const int NODE_KEYS = 16;
+
+// bytes a node is aligned to
+const int NODE_BYTES = 64;
+
+// first 4 bytes of a key, big-endian and zero padded, with the top bit
+// flipped so comparing as signed integers orders them like the strings
+static int32_t packPrefix(const string& key) {
+    uint32_t prefix = 0;
+    for(size_t i = 0; i < 4; i++) {
+        prefix <<= 8;
+        if(i < key.size()) {
+            prefix |= static_cast<unsigned char>(key[i]);
+        }
+    }
+    prefix ^= 0x80000000u;
+    int32_t biased;
+    memcpy(&biased, &prefix, sizeof(biased));
+    return biased;
+}
+
+// number of the node's 16 sorted prefixes that are less than the target
+static int countLess(const int32_t* node, int32_t target) {
+#ifdef KARY_SSE2
+    // Compare all 16 at once, narrow the four masks to bytes and count them
+    __m128i value = _mm_set1_epi32(target);
+    const __m128i* lanes = reinterpret_cast<const __m128i*>(node);
+    __m128i less0 = _mm_cmpgt_epi32(value, _mm_load_si128(lanes));
+    __m128i less1 = _mm_cmpgt_epi32(value, _mm_load_si128(lanes + 1));
+    __m128i less2 = _mm_cmpgt_epi32(value, _mm_load_si128(lanes + 2));
+    __m128i less3 = _mm_cmpgt_epi32(value, _mm_load_si128(lanes + 3));
+    __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(less0, less1),
+        _mm_packs_epi32(less2, less3));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(bytes));
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(mask);
+#else
+    // Prefixes are sorted, so the set bits are the low ones
+    int count = 0;
+    while((mask & 1) != 0) {
+        mask >>= 1;
+        count++;
+    }
+    return count;
+#endif
+#else
+    int count = 0;
+    for(int i = 0; i < NODE_KEYS; i++) {
+        count += (node[i] < target ? 1 : 0);
+    }
+    return count;
+#endif
+}
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: An empty index is created
+KaryIndex::KaryIndex() {
+    first = 0;
+    nodeCount = 0;
+}
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: An index holding a sorted copy of every object in the
+//                 BinTree argument is created, the tree is unchanged
+KaryIndex::KaryIndex(const BinTree& tree) {
+    first = 0;
+    nodeCount = 0;
+    build(tree);
+}
+
+//----------------------------------------------------------------------------
+// Copy constructor
+// Preconditions: None
+// Postconditions: A copy of the KaryIndex argument is created
+KaryIndex::KaryIndex(const KaryIndex& other) : keys(other.keys),
+storage(other.storage), first(other.first), positions(other.positions),
+nodeCount(other.nodeCount) {
+    // The copied storage may start at a different alignment
+    alignNodes();
+}
+
+//----------------------------------------------------------------------------
+// operator=
+// Preconditions: None
+// Postconditions: This index becomes a copy of the KaryIndex argument
+KaryIndex& KaryIndex::operator=(const KaryIndex& other) {
+    if(this != &other) {
+        keys = other.keys;
+        storage = other.storage;
+        first = other.first;
+        positions = other.positions;
+        nodeCount = other.nodeCount;
+        alignNodes();
+    }
+    return *this;
+}
+
+//----------------------------------------------------------------------------
+// build
+// Preconditions: None
+// Postconditions: The index's old contents are replaced by a sorted copy of
+//                 every object in the BinTree argument
+void KaryIndex::build(const BinTree& tree) {
+    tree.flatten(keys);
+    keys.shrink_to_fit();
+    vector<int32_t> sorted(keys.size());
+    for(size_t i = 0; i < keys.size(); i++) {
+        sorted[i] = packPrefix(keys[i].getData());
+    }
+    // Round up to whole nodes, the unused slots after the last key hold the
+    // largest prefix and point one past the last position
+    nodeCount = (keys.size() + NODE_KEYS - 1) / NODE_KEYS;
+    size_t slots = nodeCount * NODE_KEYS;
+    storage.assign(slots + NODE_BYTES / sizeof(int32_t), 0);
+    positions.assign(slots, static_cast<int>(keys.size()));
+    first = 0;
+    alignNodes();
+    int next = 0;
+    layoutHelper(0, next, sorted);
+}
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: None
+// Postconditions: If the NodeData argument is in the index, the pointer
+//                 argument points at the index's copy and true is returned,
+//                 otherwise it is set to nullptr and false is returned
+bool KaryIndex::retrieve(const NodeData& toFind,
+const NodeData*& toReturn) const {
+    int pos = lowerBoundHelper(toFind);
+    // The first key not less than the target is the only possible match
+    if(pos < getSize() && keys[pos] == toFind) {
+        toReturn = &keys[pos];
+        return true;
+    }
+    toReturn = nullptr;
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// lowerBound
+// Preconditions: None
+// Postconditions: Returns a pointer to the first object not less than the
+//                 NodeData argument, nullptr if there is none
+const NodeData* KaryIndex::lowerBound(const NodeData& toFind) const {
+    int pos = lowerBoundHelper(toFind);
+    return (pos < getSize() ? &keys[pos] : nullptr);
+}
+
+//----------------------------------------------------------------------------
+// getSize
+// Preconditions: None
+// Postconditions: Returns the number of objects in the index
+int KaryIndex::getSize() const {
+    return static_cast<int>(keys.size());
+}
+
+void KaryIndex::alignNodes() {
+    if(storage.empty()) {
+        return;
+    }
+    // Slide the nodes to the first 64-byte boundary in the buffer
+    uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+    size_t skip = ((NODE_BYTES - address % NODE_BYTES) % NODE_BYTES) /
+        sizeof(int32_t);
+    if(skip != first) {
+        size_t slots = nodeCount * NODE_KEYS;
+        memmove(storage.data() + skip, storage.data() + first,
+            slots * sizeof(int32_t));
+        first = skip;
+    }
+}
+
+void KaryIndex::layoutHelper(size_t node, int& next,
+const vector<int32_t>& sorted) {
+    // Base case, node is past the last one
+    if(node >= nodeCount) {
+        return;
+    }
+    // An in-order walk visits child 0, slot 0, child 1, ... child 16, so the
+    // sorted prefixes land in search tree order
+    int32_t* prefixes = storage.data() + first + node * NODE_KEYS;
+    for(int i = 0; i < NODE_KEYS; i++) {
+        layoutHelper(node * (NODE_KEYS + 1) + i + 1, next, sorted);
+        int pos = next++;
+        if(pos < static_cast<int>(sorted.size())) {
+            prefixes[i] = sorted[pos];
+            positions[node * NODE_KEYS + i] = pos;
+        }
+        else {
+            prefixes[i] = INT32_MAX;
+        }
+    }
+    layoutHelper(node * (NODE_KEYS + 1) + NODE_KEYS + 1, next, sorted);
+}
+
+int KaryIndex::prefixBoundHelper(int32_t prefix) const {
+    // Every node with a slot not less than the target is a better answer
+    // than the one above it, so the last one found is the lower bound; its
+    // sorted position is only looked up once the descent is over
+    const int32_t* nodes = storage.data() + first;
+    size_t answer = positions.size();
+    size_t node = 0;
+    while(node < nodeCount) {
+        int below = countLess(nodes + node * NODE_KEYS, prefix);
+        if(below < NODE_KEYS) {
+            answer = node * NODE_KEYS + below;
+        }
+        node = node * (NODE_KEYS + 1) + below + 1;
+    }
+    return (answer < positions.size() ? positions[answer] : getSize());
+}
+
+int KaryIndex::lowerBoundHelper(const NodeData& toFind) const {
+    int32_t prefix = packPrefix(toFind.getData());
+    int low = prefixBoundHelper(prefix);
+    // A different prefix already decides the order
+    if(low == getSize() || packPrefix(keys[low].getData()) != prefix) {
+        return low;
+    }
+    // Usually the first key with the prefix already answers
+    if(!(keys[low] < toFind)) {
+        return low;
+    }
+    // Otherwise gallop along the keys sharing the prefix, then finish with a
+    // binary search between the last key found less and the first not less
+    int count = getSize();
+    int step = 1;
+    int high = low + 1;
+    while(high < count && packPrefix(keys[high].getData()) == prefix &&
+    keys[high] < toFind) {
+        low = high;
+        step *= 2;
+        high = low + step;
+    }
+    high = min(high, count);
+    return static_cast<int>(lower_bound(keys.begin() + low + 1,
+        keys.begin() + high, toFind) - keys.begin());
+}
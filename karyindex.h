@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------
+// KARYINDEX.H
+// Class for a read-only k-ary search tree over NodeData objects
+//----------------------------------------------------------------------------
+// K-ary index: a snapshot of a BinTree as a static search tree whose nodes
+// are one 64-byte cache line of 16 key prefixes with 17 children. A node is
+// searched with one SIMD compare, so a lookup touches about log17(n) cache
+// lines instead of the log2(n) scattered nodes of BinTree::retrieve
+//      --allows retrieving NodeData objects
+//      --allows finding the first object not less than a NodeData object
+//
+// Implementation and assumptions:
+//      --node k's children are nodes 17k + 1 to 17k + 17, so no child
+//        pointers are stored
+//      --prefixes are every key's first 4 bytes; keys sharing a prefix are
+//        told apart by a binary search over the full objects
+//      --uses SSE2 where available, otherwise a scalar loop
+//      --the index holds its own copies, later changes to the tree are not
+//        seen until the index is built again
+//----------------------------------------------------------------------------
+
+#ifndef KARYINDEX_H
+#define KARYINDEX_H
+
+#include "nodedata.h"
+#include "bintree.h"
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+class KaryIndex {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: An empty index is created
+KaryIndex();
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: An index holding a sorted copy of every object in the
+//                 BinTree argument is created, the tree is unchanged
+explicit KaryIndex(const BinTree&);
+
+//----------------------------------------------------------------------------
+// Copy constructor
+// Preconditions: None
+// Postconditions: A copy of the KaryIndex argument is created
+KaryIndex(const KaryIndex&);
+
+//----------------------------------------------------------------------------
+// operator=
+// Preconditions: None
+// Postconditions: This index becomes a copy of the KaryIndex argument
+KaryIndex& operator=(const KaryIndex&);
+
+//----------------------------------------------------------------------------
+// build
+// Preconditions: None
+// Postconditions: The index's old contents are replaced by a sorted copy of
+//                 every object in the BinTree argument
+void build(const BinTree&);
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: None
+// Postconditions: If the NodeData argument is in the index, the pointer
+//                 argument points at the index's copy and true is returned,
+//                 otherwise it is set to nullptr and false is returned
+bool retrieve(const NodeData&, const NodeData*&) const;
+
+//----------------------------------------------------------------------------
+// lowerBound
+// Preconditions: None
+// Postconditions: Returns a pointer to the first object not less than the
+//                 NodeData argument, nullptr if there is none
+const NodeData* lowerBound(const NodeData&) const;
+
+//----------------------------------------------------------------------------
+// getSize
+// Preconditions: None
+// Postconditions: Returns the number of objects in the index
+int getSize() const;
+
+private:
+    vector<NodeData> keys;       // sorted copies, no duplicates
+    vector<int32_t> storage;     // node prefixes plus room to align them
+    size_t first;                // index in storage of node 0, 64-byte aligned
+    vector<int> positions;       // sorted position of every prefix slot
+    size_t nodeCount;            // nodes in the search tree
+
+    void alignNodes();                         // moves the nodes onto a
+                                               // cache line boundary
+
+    void layoutHelper(size_t, int&,            // fills node slots in-order
+        const vector<int32_t>&);               // from the sorted prefixes
+
+    int prefixBoundHelper(int32_t) const;      // first sorted position whose
+                                               // prefix is not less
+
+    int lowerBoundHelper(                      // first sorted position not
+        const NodeData&) const;                // less than the argument
+};
+
+#endif
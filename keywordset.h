@@ -0,0 +1,201 @@
+//----------------------------------------------------------------------------
+// KEYWORDSET.H
+// Class template for a fixed set of keywords built at compile time
+//----------------------------------------------------------------------------
+// Keyword set: a list of string literals sorted and deduplicated by a
+// constexpr constructor, so a set declared constexpr costs nothing to build
+// at run time and needs no heap. Lookups are a binary search over the sorted
+// keys (an implicit balanced search tree) that the compiler can evaluate at
+// compile time or fully inline for a short list:
+//      --allows testing strings and NodeData objects for membership
+//      --allows finding a keyword's rank in sorted order
+//
+// Implementation and assumptions:
+//      --keys are string literals or other strings that outlive the set
+//      --keys may not contain '\0', every other byte is allowed
+//      --bytes are ordered as unsigned, the same order as NodeData's <
+//      --everything is in this header since the class is a template
+//----------------------------------------------------------------------------
+
+#ifndef KEYWORDSET_H
+#define KEYWORDSET_H
+
+#include "nodedata.h"
+#include <cstddef>
+#include <string>
+using namespace std;
+
+template <size_t N>
+class KeywordSet {
+public:
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: every pointer in the array points at a null terminated
+//                string that outlives the set
+// Postconditions: The set holds every distinct string of the array in sorted
+//                 order; usable in a constant expression
+constexpr explicit KeywordSet(const char* const (&)[N]);
+
+//----------------------------------------------------------------------------
+// find
+// Preconditions: the pointer addresses at least the given number of bytes
+// Postconditions: Returns the sorted position of the keyword equal to the
+//                 given bytes, or -1 if none is
+constexpr int find(const char*, size_t) const;
+
+//----------------------------------------------------------------------------
+// contains
+// Preconditions: the pointer addresses at least the given number of bytes
+// Postconditions: Returns true if a keyword equals the argument, otherwise
+//                 false; the string and NodeData forms can't be constexpr as
+//                 string isn't a literal type before C++20
+constexpr bool contains(const char*, size_t) const;
+bool contains(const string&) const;
+bool contains(const NodeData&) const;
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: number of distinct keywords, and the keyword at a sorted
+//                 position from 0 to getSize() - 1
+constexpr int getSize() const;
+constexpr const char* getKey(int) const;
+
+private:
+    const char* keys[N];   // distinct keywords in sorted order
+    size_t lengths[N];     // byte length of every keyword
+    int count;             // distinct keywords, N less the duplicates
+
+    static constexpr size_t lengthHelper(   // strlen usable in a constant
+        const char*);                       // expression
+
+    static constexpr int compareHelper(     // compares two byte strings as
+        const char*, size_t, const char*,   // unsigned, negative, 0 or
+        size_t);                            // positive like strcmp
+};
+
+//----------------------------------------------------------------------------
+// makeKeywordSet
+// Preconditions: Same as the KeywordSet constructor
+// Postconditions: Returns the set of the array's strings, deducing its size
+template <size_t N>
+constexpr KeywordSet<N> makeKeywordSet(const char* const (&words)[N]) {
+    return KeywordSet<N>(words);
+}
+
+//----------------------------------------------------------------------------
+// Constructor
+template <size_t N>
+constexpr KeywordSet<N>::KeywordSet(const char* const (&words)[N])
+    : keys(), lengths(), count(0) {
+    // Insertion sort, fine for the handful of keys a keyword list holds and
+    // simple enough for the constant evaluator
+    for(size_t i = 0; i < N; i++) {
+        const char* word = words[i];
+        size_t length = lengthHelper(word);
+        int slot = count;
+        bool duplicate = false;
+        while(slot > 0) {
+            int order = compareHelper(keys[slot - 1], lengths[slot - 1], word,
+                length);
+            if(order == 0) {
+                duplicate = true;
+                break;
+            }
+            if(order < 0) {
+                break;
+            }
+            slot--;
+        }
+        if(duplicate) {
+            continue;
+        }
+        for(int j = count; j > slot; j--) {
+            keys[j] = keys[j - 1];
+            lengths[j] = lengths[j - 1];
+        }
+        keys[slot] = word;
+        lengths[slot] = length;
+        count++;
+    }
+}
+
+//----------------------------------------------------------------------------
+// find
+template <size_t N>
+constexpr int KeywordSet<N>::find(const char* text, size_t length) const {
+    int low = 0;
+    int high = count - 1;
+    while(low <= high) {
+        int mid = (low + high) / 2;
+        int order = compareHelper(keys[mid], lengths[mid], text, length);
+        if(order == 0) {
+            return mid;
+        }
+        if(order < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------------
+// contains
+template <size_t N>
+constexpr bool KeywordSet<N>::contains(const char* text, size_t length)
+const {
+    return find(text, length) >= 0;
+}
+
+template <size_t N>
+bool KeywordSet<N>::contains(const string& text) const {
+    return find(text.data(), text.size()) >= 0;
+}
+
+template <size_t N>
+bool KeywordSet<N>::contains(const NodeData& nd) const {
+    return contains(nd.getData());
+}
+
+//----------------------------------------------------------------------------
+// getters
+template <size_t N>
+constexpr int KeywordSet<N>::getSize() const {
+    return count;
+}
+
+template <size_t N>
+constexpr const char* KeywordSet<N>::getKey(int index) const {
+    return keys[index];
+}
+
+template <size_t N>
+constexpr size_t KeywordSet<N>::lengthHelper(const char* text) {
+    size_t length = 0;
+    while(text[length] != '\0') {
+        length++;
+    }
+    return length;
+}
+
+template <size_t N>
+constexpr int KeywordSet<N>::compareHelper(const char* lhs, size_t lhsLength,
+const char* rhs, size_t rhsLength) {
+    size_t shorter = (lhsLength < rhsLength ? lhsLength : rhsLength);
+    for(size_t i = 0; i < shorter; i++) {
+        unsigned char a = static_cast<unsigned char>(lhs[i]);
+        unsigned char b = static_cast<unsigned char>(rhs[i]);
+        if(a != b) {
+            return (a < b ? -1 : 1);
+        }
+    }
+    // Equal up to the shorter one, so the shorter one comes first
+    if(lhsLength == rhsLength) {
+        return 0;
+    }
+    return (lhsLength < rhsLength ? -1 : 1);
+}
+
+#endif
@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------
+// MAPPEDFILE.CPP
+// Member function definitions for class MappedFile
+//----------------------------------------------------------------------------
+// Mapped file: maps a file into the address space so its bytes can be
+// scanned in place, with no read calls, stream state or copies per token
+//
+// Assumptions:
+//      --POSIX systems map the file with mmap and hint sequential access;
+//        on _WIN32 the file is read into a buffer with an ifstream instead
+//      --an empty file is open with no bytes, mmap can't map zero bytes
+//----------------------------------------------------------------------------
+
+#include "mappedfile.h"
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed file is created, open must be called before use
+MappedFile::MappedFile() {
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: The file is unmapped and closed
+MappedFile::~MappedFile() {
+    close();
+}
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: None
+// Postconditions: Any file already open is closed, then the named file is
+//                 mapped and true is returned, or false if it can't be read
+bool MappedFile::open(const string& path) {
+    close();
+#ifdef _WIN32
+    ifstream in(path.c_str(), ios::binary | ios::ate);
+    if(!in) {
+        return false;
+    }
+    streamoff length = in.tellg();
+    in.seekg(0);
+    buffer.resize(static_cast<size_t>(length));
+    if(length > 0 && !in.read(&buffer[0], length)) {
+        buffer.clear();
+        return false;
+    }
+    size = buffer.size();
+    data = (size > 0 ? &buffer[0] : nullptr);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+    if(size > 0) {
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(address == MAP_FAILED) {
+            ::close(fd);
+            size = 0;
+            return false;
+        }
+        // Tokens are scanned front to back, so let the kernel read ahead
+        madvise(address, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(address);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+#endif
+    opened = true;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: The file is unmapped, pointers into it are invalid
+void MappedFile::close() {
+#ifdef _WIN32
+    buffer.clear();
+    buffer.shrink_to_fit();
+#else
+    if(data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: whether a file is open, its first byte (null if it is
+//                 empty or closed) and its size in bytes
+bool MappedFile::isOpen() const {
+    return opened;
+}
+
+const char* MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
@@ -0,0 +1,72 @@
+//----------------------------------------------------------------------------
+// MAPPEDFILE.H
+// Class for a read-only view of a whole file in memory
+//----------------------------------------------------------------------------
+// Mapped file: maps a file into the address space so its bytes can be
+// scanned in place, with no read calls, stream state or copies per token
+//      --allows opening and closing a file
+//      --allows reading its bytes as one contiguous array
+//
+// Implementation and assumptions:
+//      --POSIX systems map the file with mmap and hint sequential access;
+//        on _WIN32 the file is read into a buffer with an ifstream instead
+//      --the file must not be changed by anyone while it is open
+//      --pointers into the bytes are only valid until close
+//----------------------------------------------------------------------------
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+using namespace std;
+
+class MappedFile {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed file is created, open must be called before use
+MappedFile();
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: The file is unmapped and closed
+~MappedFile();
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: None
+// Postconditions: Any file already open is closed, then the named file is
+//                 mapped and true is returned, or false if it can't be read
+bool open(const string&);
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: The file is unmapped, pointers into it are invalid
+void close();
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: whether a file is open, its first byte (null if it is
+//                 empty or closed) and its size in bytes
+bool isOpen() const;
+const char* getData() const;
+size_t getSize() const;
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data;          // first byte of the file, null if empty
+    size_t size;               // bytes in the file
+    bool opened;               // a file is open, even an empty one
+#ifdef _WIN32
+    vector<char> buffer;       // the file's bytes, read in at open
+#endif
+};
+
+#endif
@@ -11,6 +11,9 @@ NodeData::NodeData(const NodeData& nd) { data = nd.data; }  // copy
 
 NodeData::NodeData(const string& s) { data = s; }    // cast string to NodeData
 
+NodeData::NodeData(const char* bytes, size_t length)    // one copy, e.g. out
+   : data(bytes, length) { }                            // of a mapped file
+
 //----------------------------------------------------------------------------
 // operator= 
 
@@ -51,6 +54,34 @@ bool NodeData::operator>=(const NodeData& rhs) const {
    return data >= rhs.data;
 }
 
+//----------------------------------------------------------------------------
+// hash 
+
+size_t NodeData::hash() const {
+   return std::hash<string>()(data);
+}
+
+//----------------------------------------------------------------------------
+// getData 
+
+const string& NodeData::getData() const {
+   return data;
+}
+
+//----------------------------------------------------------------------------
+// prefix 
+
+uint64_t NodeData::prefix() const {
+   uint64_t packed = 0;
+   for (size_t i = 0; i < 8; i++) {
+      packed <<= 8;
+      if (i < data.size()) {
+         packed |= static_cast<unsigned char>(data[i]);
+      }
+   }
+   return packed;
+}
+
 //----------------------------------------------------------------------------
 // setData 
 // returns true if the data is set, false when bad data, i.e., is eof
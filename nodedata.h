@@ -1,5 +1,6 @@
 #ifndef NODEDATA_H
 #define NODEDATA_H
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -15,6 +16,7 @@ public:
    NodeData();          // default constructor, data is set to an empty string
    ~NodeData();          
    NodeData(const string &);      // data is set equal to parameter
+   NodeData(const char*, size_t); // data is set to the given bytes
    NodeData(const NodeData &);    // copy constructor
    NodeData& operator=(const NodeData &);
 
@@ -29,6 +31,11 @@ public:
    bool operator<=(const NodeData &) const;
    bool operator>=(const NodeData &) const;
 
+   size_t hash() const;  // equal objects hash equally
+   const string& getData() const;  // the string held, for packed indexes
+   uint64_t prefix() const;  // first 8 bytes big-endian, zero padded; orders
+                             // like the strings whenever two prefixes differ
+
 private:
    string data;          
 };
@@ -0,0 +1,527 @@
+//----------------------------------------------------------------------------
+// PAGEDTREE.CPP
+// Member function definitions for class PagedTree
+//----------------------------------------------------------------------------
+// Paged tree: a B+-tree whose nodes are 4 KB pages of a local file, reached
+// through a BufferPool of a fixed number of pages
+//
+// Assumptions:
+//      --page 0 describes the tree, every other page is one node
+//      --page 0 is rewritten when the root changes, the object count only
+//        on flush and close, so a file not closed may report an old count
+//      --objects are stored as their strings, at most 512 bytes each
+//      --page contents use the machine's byte order
+//----------------------------------------------------------------------------
+
+#include "pagedtree.h"
+#include <algorithm>
+#include <cstring>
+
+// longest object string stored, so a split always leaves halves that fit
+const size_t MAX_KEY_BYTES = 512;
+
+// identifies a tree file and its page format
+const uint32_t FILE_MAGIC = 0x50545245;     // "PTRE"
+const uint32_t FILE_VERSION = 1;
+
+// node page header: leaf flag, key count, next leaf
+const size_t HEADER_BYTES = 1 + 2 + 4;
+
+// copies a value to or from a page at an offset, advancing the offset
+template <typename T>
+static void putValue(char* page, size_t& offset, T value) {
+    memcpy(page + offset, &value, sizeof(T));
+    offset += sizeof(T);
+}
+
+template <typename T>
+static T getValue(const char* page, size_t& offset) {
+    T value;
+    memcpy(&value, page + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed tree is created, open or create must be called
+//                 before use
+PagedTree::PagedTree() {
+    rootPage = 0;
+    keyCount = 0;
+    height = 0;
+    headerStale = false;
+}
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: Changed pages are written to the file and it is closed
+PagedTree::~PagedTree() {
+    close();
+}
+
+//----------------------------------------------------------------------------
+// create
+// Preconditions: Number of pool pages is positive
+// Postconditions: The file is emptied or created and holds an empty tree,
+//                 with at most the given number of pages in memory. Returns
+//                 false if the file can't be created
+bool PagedTree::create(const string& path, int poolPages) {
+    close();
+    if(!pool.open(path, poolPages, true)) {
+        return false;
+    }
+    // Page 0 is the header, page 1 the first, empty, leaf
+    Page root;
+    root.leaf = true;
+    root.next = 0;
+    uint32_t header = pool.allocate();
+    rootPage = pool.allocate();
+    if(header != 0 || rootPage == 0 || !writePage(rootPage, root)) {
+        pool.close();
+        return false;
+    }
+    keyCount = 0;
+    height = 1;
+    return writeHeader();
+}
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: Number of pool pages is positive
+// Postconditions: A tree saved in the file earlier is opened, or a new one
+//                 created if the file is missing or empty, with at most the
+//                 given number of pages in memory. Returns false if the file
+//                 can't be opened or doesn't hold a tree
+bool PagedTree::open(const string& path, int poolPages) {
+    close();
+    if(!pool.open(path, poolPages, false) || pool.getPageCount() == 0) {
+        pool.close();
+        return create(path, poolPages);
+    }
+    const char* header = pool.fetch(0, false);
+    size_t offset = 0;
+    if(header == nullptr || getValue<uint32_t>(header, offset) != FILE_MAGIC ||
+    getValue<uint32_t>(header, offset) != FILE_VERSION) {
+        pool.close();
+        return false;
+    }
+    rootPage = getValue<uint32_t>(header, offset);
+    keyCount = getValue<long long>(header, offset);
+    height = getValue<int>(header, offset);
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: Changed pages are written to the file and it is closed
+void PagedTree::close() {
+    if(isOpen() && headerStale) {
+        writeHeader();
+    }
+    pool.close();
+    rootPage = 0;
+    keyCount = 0;
+    height = 0;
+    headerStale = false;
+}
+
+//----------------------------------------------------------------------------
+// isOpen
+// Preconditions: None
+// Postconditions: Returns true if a tree file is open, otherwise false
+bool PagedTree::isOpen() const {
+    return pool.isOpen();
+}
+
+//----------------------------------------------------------------------------
+// insert
+// Preconditions: Tree is open
+// Postconditions: If an equal object isn't already in the tree, a copy is
+//                 added and true is returned. False is returned for a
+//                 duplicate, an object over 512 bytes, or a file error
+bool PagedTree::insert(const NodeData& toInsert) {
+    const string& key = toInsert.getData();
+    if(!isOpen() || key.size() > MAX_KEY_BYTES) {
+        return false;
+    }
+    bool inserted = false;
+    bool split = false;
+    string separator;
+    uint32_t right = 0;
+    if(!insertHelper(rootPage, key, inserted, split, separator, right)) {
+        return false;
+    }
+    // A split root gets a new root above it, the only way the tree grows
+    if(split) {
+        Page root;
+        root.leaf = false;
+        root.next = 0;
+        root.keys.push_back(separator);
+        root.children.push_back(rootPage);
+        root.children.push_back(right);
+        uint32_t page = pool.allocate();
+        if(page == 0 || !writePage(page, root)) {
+            return false;
+        }
+        rootPage = page;
+        height++;
+    }
+    if(!inserted) {
+        return false;
+    }
+    // Only a new root has to reach page 0 at once, the count waits for a
+    // flush or close so inserts don't dirty the header page every time
+    keyCount++;
+    headerStale = true;
+    return !split || writeHeader();
+}
+
+bool PagedTree::insertHelper(uint32_t pageId, const string& key,
+bool& inserted, bool& split, string& separator, uint32_t& right) {
+    split = false;
+    Page node;
+    const char* page = pool.fetch(pageId, false);
+    if(page == nullptr) {
+        return false;
+    }
+    if(page[0] == 0) {
+        // Inner pages are only decoded when a child split adds a separator
+        bool childSplit = false;
+        string childSeparator;
+        uint32_t childRight = 0;
+        if(!insertHelper(childHelper(page, key), key, inserted, childSplit,
+        childSeparator, childRight)) {
+            return false;
+        }
+        if(!childSplit) {
+            return true;
+        }
+        if(!readPage(pageId, node)) {
+            return false;
+        }
+        size_t i = upper_bound(node.keys.begin(), node.keys.end(), key) -
+            node.keys.begin();
+        node.keys.insert(node.keys.begin() + i, childSeparator);
+        node.children.insert(node.children.begin() + i + 1, childRight);
+    }
+    else {
+        // Find the key's slot and the end of the used bytes in place
+        size_t offset = 1;
+        uint16_t count = getValue<uint16_t>(page, offset);
+        getValue<uint32_t>(page, offset);
+        size_t slot = 0;
+        bool placed = false;
+        for(uint16_t i = 0; i < count; i++) {
+            size_t start = offset;
+            uint16_t length = getValue<uint16_t>(page, offset);
+            if(!placed) {
+                int order = key.compare(0, string::npos, page + offset,
+                    length);
+                if(order == 0) {
+                    inserted = false;
+                    return true;
+                }
+                if(order < 0) {
+                    slot = start;
+                    placed = true;
+                }
+            }
+            offset += length;
+        }
+        if(!placed) {
+            slot = offset;
+        }
+        inserted = true;
+        // Usually the key fits: shift the later keys over and write it
+        size_t needed = 2 + key.size();
+        if(offset + needed <= static_cast<size_t>(BufferPool::PAGE_SIZE)) {
+            char* writable = pool.fetch(pageId, true);
+            if(writable == nullptr) {
+                return false;
+            }
+            memmove(writable + slot + needed, writable + slot, offset - slot);
+            putValue<uint16_t>(writable, slot,
+                static_cast<uint16_t>(key.size()));
+            memcpy(writable + slot, key.data(), key.size());
+            size_t at = 1;
+            putValue<uint16_t>(writable, at, count + 1);
+            return true;
+        }
+        // A full leaf is decoded and split below
+        if(!readPage(pageId, node)) {
+            return false;
+        }
+        node.keys.insert(lower_bound(node.keys.begin(), node.keys.end(), key),
+            key);
+    }
+    if(encodedSize(node) <= static_cast<size_t>(BufferPool::PAGE_SIZE)) {
+        return writePage(pageId, node);
+    }
+    // Split where the left half reaches half the bytes, keys vary in length
+    size_t total = 0;
+    for(const string& k : node.keys) {
+        total += k.size();
+    }
+    size_t middle = 0;
+    size_t bytes = 0;
+    while(middle < node.keys.size() - 1 && bytes < total / 2) {
+        bytes += node.keys[middle].size();
+        middle++;
+    }
+    middle = max(middle, static_cast<size_t>(1));
+    Page other;
+    other.leaf = node.leaf;
+    other.next = 0;
+    right = pool.allocate();
+    if(right == 0) {
+        return false;
+    }
+    if(node.leaf) {
+        // Leaves copy their first key up and stay chained for scans
+        other.keys.assign(node.keys.begin() + middle, node.keys.end());
+        node.keys.resize(middle);
+        other.next = node.next;
+        node.next = right;
+        separator = other.keys.front();
+    }
+    else {
+        // Inner pages move their middle separator up
+        separator = node.keys[middle];
+        other.keys.assign(node.keys.begin() + middle + 1, node.keys.end());
+        other.children.assign(node.children.begin() + middle + 1,
+            node.children.end());
+        node.keys.resize(middle);
+        node.children.resize(middle + 1);
+    }
+    split = true;
+    return writePage(pageId, node) && writePage(right, other);
+}
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: Tree is open
+// Postconditions: If the 1st argument is in the tree, the stored object is
+//                 copied into the 2nd and true is returned, otherwise false
+bool PagedTree::retrieve(const NodeData& toFind, NodeData& toReturn) {
+    const string& key = toFind.getData();
+    uint32_t leafPage;
+    if(!descendHelper(key, leafPage)) {
+        return false;
+    }
+    const char* page = pool.fetch(leafPage, false);
+    if(page == nullptr) {
+        return false;
+    }
+    // Compare against the stored bytes in place, keys are in order so the
+    // first one not less than the target settles it
+    size_t offset = 1;
+    uint16_t count = getValue<uint16_t>(page, offset);
+    getValue<uint32_t>(page, offset);
+    for(uint16_t i = 0; i < count; i++) {
+        uint16_t length = getValue<uint16_t>(page, offset);
+        int order = key.compare(0, string::npos, page + offset, length);
+        offset += length;
+        if(order <= 0) {
+            if(order == 0) {
+                toReturn = toFind;
+                return true;
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// rangeScan
+// Preconditions: Tree is open, first NodeData argument is not greater than
+//                the second
+// Postconditions: Every object from the 1st argument to the 2nd (both
+//                 included) is appended in order to the vector, stopping
+//                 after the given limit if it is positive. Returns the number
+//                 appended
+int PagedTree::rangeScan(const NodeData& low, const NodeData& high,
+vector<NodeData>& found, int limit) {
+    const string& first = low.getData();
+    const string& last = high.getData();
+    Page leaf;
+    if(!findLeaf(first, leaf)) {
+        return 0;
+    }
+    int count = 0;
+    size_t i = lower_bound(leaf.keys.begin(), leaf.keys.end(), first) -
+        leaf.keys.begin();
+    // Walk the leaf chain until a key passes the end of the range
+    for(;;) {
+        for(; i < leaf.keys.size(); i++) {
+            if(leaf.keys[i] > last || (limit > 0 && count == limit)) {
+                return count;
+            }
+            found.push_back(NodeData(leaf.keys[i]));
+            count++;
+        }
+        if(leaf.next == 0 || !readPage(leaf.next, leaf)) {
+            return count;
+        }
+        i = 0;
+    }
+}
+
+//----------------------------------------------------------------------------
+// flush
+// Preconditions: None
+// Postconditions: Changed pages are written to the file, returns false on a
+//                 file error
+bool PagedTree::flush() {
+    if(!isOpen() || (headerStale && !writeHeader())) {
+        return false;
+    }
+    return pool.flush();
+}
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: objects in the tree, page levels, and the buffer pool's
+//                 page hit statistics
+long long PagedTree::getSize() const {
+    return keyCount;
+}
+
+int PagedTree::getHeight() const {
+    return height;
+}
+
+BufferPool::Stats PagedTree::getStats() const {
+    return pool.getStats();
+}
+
+//----------------------------------------------------------------------------
+// resetStats
+// Preconditions: None
+// Postconditions: The buffer pool's counters are set to zero
+void PagedTree::resetStats() {
+    pool.resetStats();
+}
+
+bool PagedTree::writeHeader() {
+    char* header = pool.fetch(0, true);
+    if(header == nullptr) {
+        return false;
+    }
+    size_t offset = 0;
+    putValue<uint32_t>(header, offset, FILE_MAGIC);
+    putValue<uint32_t>(header, offset, FILE_VERSION);
+    putValue<uint32_t>(header, offset, rootPage);
+    putValue<long long>(header, offset, keyCount);
+    putValue<int>(header, offset, height);
+    headerStale = false;
+    return true;
+}
+
+bool PagedTree::readPage(uint32_t pageId, Page& node) {
+    const char* page = pool.fetch(pageId, false);
+    if(page == nullptr) {
+        return false;
+    }
+    // Layout: leaf flag, key count, next leaf, then for a leaf every key as
+    // length and bytes, for an inner page child 0 then length, bytes and
+    // child for every key
+    size_t offset = 0;
+    node.leaf = (getValue<uint8_t>(page, offset) != 0);
+    uint16_t count = getValue<uint16_t>(page, offset);
+    node.next = getValue<uint32_t>(page, offset);
+    node.keys.resize(count);
+    node.children.clear();
+    if(!node.leaf) {
+        node.children.push_back(getValue<uint32_t>(page, offset));
+    }
+    for(uint16_t i = 0; i < count; i++) {
+        uint16_t length = getValue<uint16_t>(page, offset);
+        node.keys[i].assign(page + offset, length);
+        offset += length;
+        if(!node.leaf) {
+            node.children.push_back(getValue<uint32_t>(page, offset));
+        }
+    }
+    return true;
+}
+
+bool PagedTree::writePage(uint32_t pageId, const Page& node) {
+    char* page = pool.fetch(pageId, true);
+    if(page == nullptr) {
+        return false;
+    }
+    memset(page, 0, BufferPool::PAGE_SIZE);
+    size_t offset = 0;
+    putValue<uint8_t>(page, offset, node.leaf ? 1 : 0);
+    putValue<uint16_t>(page, offset, static_cast<uint16_t>(node.keys.size()));
+    putValue<uint32_t>(page, offset, node.next);
+    if(!node.leaf) {
+        putValue<uint32_t>(page, offset, node.children[0]);
+    }
+    for(size_t i = 0; i < node.keys.size(); i++) {
+        putValue<uint16_t>(page, offset,
+            static_cast<uint16_t>(node.keys[i].size()));
+        memcpy(page + offset, node.keys[i].data(), node.keys[i].size());
+        offset += node.keys[i].size();
+        if(!node.leaf) {
+            putValue<uint32_t>(page, offset, node.children[i + 1]);
+        }
+    }
+    return true;
+}
+
+size_t PagedTree::encodedSize(const Page& node) const {
+    size_t bytes = HEADER_BYTES + (node.leaf ? 0 : 4);
+    for(const string& key : node.keys) {
+        bytes += 2 + key.size() + (node.leaf ? 0 : 4);
+    }
+    return bytes;
+}
+
+bool PagedTree::findLeaf(const string& key, Page& node) {
+    uint32_t leafPage;
+    return descendHelper(key, leafPage) && readPage(leafPage, node);
+}
+
+bool PagedTree::descendHelper(const string& key, uint32_t& leafPage) {
+    if(!isOpen()) {
+        return false;
+    }
+    uint32_t pageId = rootPage;
+    for(;;) {
+        const char* page = pool.fetch(pageId, false);
+        if(page == nullptr) {
+            return false;
+        }
+        if(page[0] != 0) {
+            leafPage = pageId;
+            return true;
+        }
+        pageId = childHelper(page, key);
+    }
+}
+
+uint32_t PagedTree::childHelper(const char* page, const string& key) const {
+    // Read the separators in place, without decoding the page; they are the
+    // first key on their right, so equal keys go right
+    size_t offset = 1;
+    uint16_t count = getValue<uint16_t>(page, offset);
+    getValue<uint32_t>(page, offset);
+    uint32_t child = getValue<uint32_t>(page, offset);
+    for(uint16_t i = 0; i < count; i++) {
+        uint16_t length = getValue<uint16_t>(page, offset);
+        int order = key.compare(0, string::npos, page + offset, length);
+        offset += length;
+        uint32_t right = getValue<uint32_t>(page, offset);
+        if(order < 0) {
+            break;
+        }
+        child = right;
+    }
+    return child;
+}
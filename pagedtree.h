@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------------
+// PAGEDTREE.H
+// Class for a disk-backed B+-tree of NodeData objects
+//----------------------------------------------------------------------------
+// Paged tree: a B+-tree whose nodes are 4 KB pages of a local file, reached
+// through a BufferPool of a fixed number of pages, so key sets larger than
+// RAM can be loaded with memory use capped explicitly
+//      --allows inserting NodeData objects
+//      --allows retrieving NodeData objects
+//      --allows scanning every object in a range in order
+//      --allows reopening a tree saved in a file earlier
+//      --allows reporting page hits and transfers
+//
+// Implementation and assumptions:
+//      --page 0 describes the tree, every other page is one node
+//      --page 0 is rewritten when the root changes, the object count only
+//        on flush and close, so a file not closed may report an old count
+//      --leaves hold the objects and are chained left to right for scans,
+//        inner pages hold separators: the first key of the right subtree
+//      --objects are stored as their strings, at most 512 bytes each, and
+//        the tree keeps copies, callers keep ownership of what they pass
+//      --page contents use the machine's byte order, the file is a local
+//        store rather than an exchange format
+//      --not synchronized between threads
+//----------------------------------------------------------------------------
+
+#ifndef PAGEDTREE_H
+#define PAGEDTREE_H
+
+#include "nodedata.h"
+#include "bufferpool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+class PagedTree {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed tree is created, open or create must be called
+//                 before use
+PagedTree();
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: Changed pages are written to the file and it is closed
+~PagedTree();
+
+//----------------------------------------------------------------------------
+// create
+// Preconditions: Number of pool pages is positive
+// Postconditions: The file is emptied or created and holds an empty tree,
+//                 with at most the given number of pages in memory. Returns
+//                 false if the file can't be created
+bool create(const string&, int);
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: Number of pool pages is positive
+// Postconditions: A tree saved in the file earlier is opened, or a new one
+//                 created if the file is missing or empty, with at most the
+//                 given number of pages in memory. Returns false if the file
+//                 can't be opened or doesn't hold a tree
+bool open(const string&, int);
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: Changed pages are written to the file and it is closed
+void close();
+
+//----------------------------------------------------------------------------
+// isOpen
+// Preconditions: None
+// Postconditions: Returns true if a tree file is open, otherwise false
+bool isOpen() const;
+
+//----------------------------------------------------------------------------
+// insert
+// Preconditions: Tree is open
+// Postconditions: If an equal object isn't already in the tree, a copy is
+//                 added and true is returned. False is returned for a
+//                 duplicate, an object over 512 bytes, or a file error
+bool insert(const NodeData&);
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: Tree is open
+// Postconditions: If the 1st argument is in the tree, the stored object is
+//                 copied into the 2nd and true is returned, otherwise false
+bool retrieve(const NodeData&, NodeData&);
+
+//----------------------------------------------------------------------------
+// rangeScan
+// Preconditions: Tree is open, first NodeData argument is not greater than
+//                the second
+// Postconditions: Every object from the 1st argument to the 2nd (both
+//                 included) is appended in order to the vector, stopping
+//                 after the given limit if it is positive. Returns the number
+//                 appended
+int rangeScan(const NodeData&, const NodeData&, vector<NodeData>&, int);
+
+//----------------------------------------------------------------------------
+// flush
+// Preconditions: None
+// Postconditions: Changed pages are written to the file, returns false on a
+//                 file error
+bool flush();
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: objects in the tree, page levels, and the buffer pool's
+//                 page hit statistics
+long long getSize() const;
+int getHeight() const;
+BufferPool::Stats getStats() const;
+
+//----------------------------------------------------------------------------
+// resetStats
+// Preconditions: None
+// Postconditions: The buffer pool's counters are set to zero
+void resetStats();
+
+private:
+    struct Page {
+        bool leaf;                   // page holds objects, not separators
+        uint32_t next;               // next leaf to the right, 0 if none
+        vector<string> keys;         // objects, or separators, in order
+        vector<uint32_t> children;   // inner pages: keys.size() + 1 pages
+    };
+
+    BufferPool pool;     // the file and the pages held in memory
+    uint32_t rootPage;   // page of the root node
+    long long keyCount;  // objects in the tree
+    int height;          // page levels, 1 for a lone leaf
+    bool headerStale;    // count changed since page 0 was last written
+
+    bool writeHeader();                        // saves root, count and height
+                                               // to page 0
+
+    bool readPage(uint32_t, Page&);            // decodes a node page
+
+    bool writePage(uint32_t, const Page&);     // encodes a node page
+
+    size_t encodedSize(const Page&) const;     // bytes a node page needs
+
+    bool insertHelper(uint32_t, const string&, // recursive helper for insert,
+        bool&, bool&, string&, uint32_t&);     // reports a split upward
+
+    bool findLeaf(const string&, Page&);       // leaf where the key belongs
+
+    bool descendHelper(const string&,          // page of that leaf, found
+        uint32_t&);                            // without decoding pages
+
+    uint32_t childHelper(const char*,          // child of an inner page to
+        const string&) const;                  // follow, read in place
+};
+
+#endif
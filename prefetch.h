@@ -0,0 +1,30 @@
+//----------------------------------------------------------------------------
+// PREFETCH.H
+// Cache prefetch hint shared by the tree and index search code
+//----------------------------------------------------------------------------
+// Prefetch: asks the CPU to start loading memory that a search will read a
+// few steps later, hiding part of the cache miss behind current work
+//      --allows hinting that an address will be read soon
+//
+// Implementation and assumptions:
+//      --GCC and clang use __builtin_prefetch, any other compiler gets a
+//        no-op, which changes timing but never results
+//      --everything is inline in this header
+//----------------------------------------------------------------------------
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+//----------------------------------------------------------------------------
+// prefetchRead
+// Preconditions: None, the address doesn't have to be valid
+// Postconditions: The cache line holding the address may be loading
+inline void prefetchRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#else
+    (void)address;
+#endif
+}
+
+#endif
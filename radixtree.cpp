@@ -0,0 +1,554 @@
+//----------------------------------------------------------------------------
+// RADIXTREE.CPP
+// Member function definitions for class RadixTree
+//----------------------------------------------------------------------------
+// Radix tree: stores NodeData objects by the bytes of their strings, one
+// byte per level, with inner nodes of 4, 16, 48 or 256 slots and single
+// child chains folded into a stored prefix
+//
+// Assumptions:
+//      --user will pass pointers to NodeData objects to add nodes to the tree
+//      --a leaf is only reached through the bytes before it, so checking it
+//        compares just the rest of the string, once per lookup
+//      --nodes only grow; objects are never removed one at a time
+//----------------------------------------------------------------------------
+
+#include "radixtree.h"
+#include "bitops.h"
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RADIX_SSE2 1
+#endif
+
+//----------------------------------------------------------------------------
+// operator<<
+// Preconditions: None
+// Postconditions: Nothing outputted if tree is empty, otherwise each NodeData
+//                 object of the tree is put into the ostream in sorted order
+ostream& operator<<(ostream& os, const RadixTree& radixTree) {
+    vector<const NodeData*> objects;
+    radixTree.visitHelper(radixTree.root, objects);
+    for(size_t i = 0; i < objects.size(); i++) {
+        os << *objects[i] << " ";
+    }
+    os << endl;
+    return os;
+}
+
+void RadixTree::visitHelper(const Node* curPtr,
+vector<const NodeData*>& objects) const {
+    // Base case, node doesn't exist
+    if(curPtr == nullptr) {
+        return;
+    }
+    if(curPtr->type == LEAF) {
+        objects.push_back(static_cast<const Leaf*>(curPtr)->data);
+        return;
+    }
+    // A string ending here is a prefix of, so comes before, all below it
+    const Inner* inner = static_cast<const Inner*>(curPtr);
+    if(inner->end != nullptr) {
+        objects.push_back(inner->end->data);
+    }
+    switch(curPtr->type) {
+    case NODE4: {
+        const Node4* node = static_cast<const Node4*>(curPtr);
+        for(int i = 0; i < node->count; i++) {
+            visitHelper(node->children[i], objects);
+        }
+        break;
+    }
+    case NODE16: {
+        const Node16* node = static_cast<const Node16*>(curPtr);
+        for(int i = 0; i < node->count; i++) {
+            visitHelper(node->children[i], objects);
+        }
+        break;
+    }
+    case NODE48: {
+        const Node48* node = static_cast<const Node48*>(curPtr);
+        for(int b = 0; b < 256; b++) {
+            if(node->index[b] != 0) {
+                visitHelper(node->children[node->index[b] - 1], objects);
+            }
+        }
+        break;
+    }
+    default: {
+        const Node256* node = static_cast<const Node256*>(curPtr);
+        for(int b = 0; b < 256; b++) {
+            visitHelper(node->children[b], objects);
+        }
+        break;
+    }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: Empty tree is created
+RadixTree::RadixTree() {
+    root = nullptr;
+    size = 0;
+}
+
+//----------------------------------------------------------------------------
+// Copy constructor
+// Preconditions: None
+// Postconditions: A deep copy of the RadixTree argument is created
+RadixTree::RadixTree(const RadixTree& otherTree) {
+    root = nullptr;
+    size = 0;
+    *this = otherTree;
+}
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: Every node and NodeData object is deleted
+RadixTree::~RadixTree() {
+    makeEmpty();
+}
+
+//----------------------------------------------------------------------------
+// operator=
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it becomes a deep
+//                 copy of the RadixTree argument
+RadixTree& RadixTree::operator=(const RadixTree& otherTree) {
+    // Self-assignment check
+    if(this != &otherTree) {
+        makeEmpty();
+        vector<const NodeData*> objects;
+        otherTree.visitHelper(otherTree.root, objects);
+        for(size_t i = 0; i < objects.size(); i++) {
+            insert(new NodeData(*objects[i]));
+        }
+    }
+    return *this;
+}
+
+//----------------------------------------------------------------------------
+// isEmpty
+// Preconditions: None
+// Postconditions: Returns true if the tree is empty, otherwise false
+bool RadixTree::isEmpty() const {
+    return root == nullptr;
+}
+
+//----------------------------------------------------------------------------
+// makeEmpty
+// Preconditions: None
+// Postconditions: Every node and NodeData object is deleted
+void RadixTree::makeEmpty() {
+    makeEmptyHelper(root);
+    size = 0;
+}
+
+void RadixTree::makeEmptyHelper(Node*& treeNode) {
+    // Base case, node doesn't exist so terminate
+    if(treeNode == nullptr) {
+        return;
+    }
+    if(treeNode->type == LEAF) {
+        delete static_cast<Leaf*>(treeNode)->data;
+        deleteNode(treeNode);
+        treeNode = nullptr;
+        return;
+    }
+    Inner* inner = static_cast<Inner*>(treeNode);
+    if(inner->end != nullptr) {
+        Node* end = inner->end;
+        makeEmptyHelper(end);
+    }
+    switch(treeNode->type) {
+    case NODE4: {
+        Node4* node = static_cast<Node4*>(treeNode);
+        for(int i = 0; i < node->count; i++) {
+            makeEmptyHelper(node->children[i]);
+        }
+        break;
+    }
+    case NODE16: {
+        Node16* node = static_cast<Node16*>(treeNode);
+        for(int i = 0; i < node->count; i++) {
+            makeEmptyHelper(node->children[i]);
+        }
+        break;
+    }
+    case NODE48: {
+        Node48* node = static_cast<Node48*>(treeNode);
+        for(int i = 0; i < node->count; i++) {
+            makeEmptyHelper(node->children[i]);
+        }
+        break;
+    }
+    default: {
+        Node256* node = static_cast<Node256*>(treeNode);
+        for(int b = 0; b < 256; b++) {
+            makeEmptyHelper(node->children[b]);
+        }
+        break;
+    }
+    }
+    deleteNode(treeNode);
+    treeNode = nullptr;
+}
+
+void RadixTree::deleteNode(Node* treeNode) {
+    // No virtual destructor, so delete through the real type
+    switch(treeNode->type) {
+    case LEAF:
+        delete static_cast<Leaf*>(treeNode);
+        break;
+    case NODE4:
+        delete static_cast<Node4*>(treeNode);
+        break;
+    case NODE16:
+        delete static_cast<Node16*>(treeNode);
+        break;
+    case NODE48:
+        delete static_cast<Node48*>(treeNode);
+        break;
+    default:
+        delete static_cast<Node256*>(treeNode);
+        break;
+    }
+}
+
+//----------------------------------------------------------------------------
+// insert
+// Preconditions: NodeData argument is dynamically allocated
+// Postconditions: If an equal object isn't already in the tree, the object is
+//                 added and true is returned, otherwise false is returned and
+//                 the caller still owns the object
+bool RadixTree::insert(NodeData* dataptr) {
+    if(dataptr == nullptr) {
+        return false;
+    }
+    if(insertHelper(root, dataptr, 0)) {
+        size++;
+        return true;
+    }
+    return false;
+}
+
+bool RadixTree::insertHelper(Node*& treeNode, NodeData* dataptr,
+size_t depth) {
+    const string& key = dataptr->getData();
+    // Empty slot, the object becomes a leaf here
+    if(treeNode == nullptr) {
+        treeNode = newLeaf(dataptr);
+        return true;
+    }
+    // Leaf: replace it with an inner node holding the bytes both strings
+    // share, then hang both leaves below it
+    if(treeNode->type == LEAF) {
+        Leaf* leaf = static_cast<Leaf*>(treeNode);
+        const string& other = leaf->data->getData();
+        size_t common = 0;
+        while(depth + common < key.size() && depth + common < other.size() &&
+        key[depth + common] == other[depth + common]) {
+            common++;
+        }
+        if(depth + common == key.size() && depth + common == other.size()) {
+            return false;
+        }
+        Node4* node = newNode4(key.substr(depth, common));
+        Node* inner = node;
+        depth += common;
+        if(depth == other.size()) {
+            node->end = leaf;
+        }
+        else {
+            addChild(inner, static_cast<uint8_t>(other[depth]), leaf);
+        }
+        if(depth == key.size()) {
+            node->end = newLeaf(dataptr);
+        }
+        else {
+            addChild(inner, static_cast<uint8_t>(key[depth]),
+                newLeaf(dataptr));
+        }
+        treeNode = inner;
+        return true;
+    }
+    Inner* inner = static_cast<Inner*>(treeNode);
+    const string& prefix = inner->prefix;
+    size_t match = 0;
+    while(match < prefix.size() && depth + match < key.size() &&
+    prefix[match] == key[depth + match]) {
+        match++;
+    }
+    // The string leaves the stored prefix part way: split the prefix with a
+    // new node at the point they differ
+    if(match < prefix.size()) {
+        Node4* node = newNode4(prefix.substr(0, match));
+        Node* parent = node;
+        uint8_t oldByte = static_cast<uint8_t>(prefix[match]);
+        inner->prefix.erase(0, match + 1);
+        addChild(parent, oldByte, treeNode);
+        depth += match;
+        if(depth == key.size()) {
+            node->end = newLeaf(dataptr);
+        }
+        else {
+            addChild(parent, static_cast<uint8_t>(key[depth]),
+                newLeaf(dataptr));
+        }
+        treeNode = parent;
+        return true;
+    }
+    depth += prefix.size();
+    // The string ends at this node
+    if(depth == key.size()) {
+        if(inner->end != nullptr) {
+            return false;
+        }
+        inner->end = newLeaf(dataptr);
+        return true;
+    }
+    uint8_t byte = static_cast<uint8_t>(key[depth]);
+    Node** child = findChild(inner, byte);
+    if(child != nullptr) {
+        return insertHelper(*child, dataptr, depth + 1);
+    }
+    addChild(treeNode, byte, newLeaf(dataptr));
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: second NodeData argument is unallocated and is expected to be
+//                assigned to the found object
+// Postconditions: If the 1st argument is found, the pointer argument points
+//                 at the tree's object and true is returned, otherwise false
+bool RadixTree::retrieve(const NodeData& target, NodeData*& found) const {
+    const string& key = target.getData();
+    const Node* cur = root;
+    size_t depth = 0;
+    while(cur != nullptr) {
+        if(cur->type == LEAF) {
+            // Every byte before depth was matched on the way down
+            const Leaf* leaf = static_cast<const Leaf*>(cur);
+            const string& other = leaf->data->getData();
+            if(other.size() == key.size() && memcmp(other.data() + depth,
+            key.data() + depth, key.size() - depth) == 0) {
+                found = leaf->data;
+                return true;
+            }
+            return false;
+        }
+        const Inner* inner = static_cast<const Inner*>(cur);
+        size_t length = inner->prefix.size();
+        if(key.size() - depth < length ||
+        memcmp(inner->prefix.data(), key.data() + depth, length) != 0) {
+            return false;
+        }
+        depth += length;
+        if(depth == key.size()) {
+            cur = inner->end;
+        }
+        else {
+            Node** child = findChild(const_cast<Inner*>(inner),
+                static_cast<uint8_t>(key[depth]));
+            cur = (child != nullptr ? *child : nullptr);
+            depth++;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// flatten
+// Preconditions: None
+// Postconditions: The vector argument is replaced by a copy of every object in
+//                 the tree in sorted order; the tree is left unchanged
+void RadixTree::flatten(vector<NodeData>& out) const {
+    vector<const NodeData*> objects;
+    objects.reserve(size);
+    visitHelper(root, objects);
+    out.clear();
+    out.reserve(objects.size());
+    for(size_t i = 0; i < objects.size(); i++) {
+        out.push_back(*objects[i]);
+    }
+}
+
+//----------------------------------------------------------------------------
+// getSize
+// Preconditions: None
+// Postconditions: Returns the number of objects in the tree
+int RadixTree::getSize() const {
+    return size;
+}
+
+//----------------------------------------------------------------------------
+// newLeaf and newNode4
+// Preconditions: None
+// Postconditions: Returns a leaf for the object, or an empty 4 slot inner
+//                 node with the given prefix
+RadixTree::Leaf* RadixTree::newLeaf(NodeData* dataptr) const {
+    Leaf* leaf = new Leaf;
+    leaf->type = LEAF;
+    leaf->data = dataptr;
+    return leaf;
+}
+
+RadixTree::Node4* RadixTree::newNode4(const string& prefix) const {
+    Node4* node = new Node4;
+    node->type = NODE4;
+    node->count = 0;
+    node->prefix = prefix;
+    node->end = nullptr;
+    return node;
+}
+
+//----------------------------------------------------------------------------
+// findChild
+// Preconditions: Node argument is an inner node
+// Postconditions: Returns the slot holding the child for the byte, or null if
+//                 the node has none
+RadixTree::Node** RadixTree::findChild(Inner* inner, uint8_t byte) const {
+    switch(inner->type) {
+    case NODE4: {
+        Node4* node = static_cast<Node4*>(inner);
+        for(int i = 0; i < node->count; i++) {
+            if(node->keys[i] == byte) {
+                return &node->children[i];
+            }
+        }
+        return nullptr;
+    }
+    case NODE16: {
+        Node16* node = static_cast<Node16*>(inner);
+#ifdef RADIX_SSE2
+        // Compare all 16 bytes at once and keep the slots in use
+        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->keys)));
+        int mask = _mm_movemask_epi8(cmp) & ((1 << node->count) - 1);
+        if(mask != 0) {
+            return &node->children[lowestBit(static_cast<uint32_t>(mask))];
+        }
+        return nullptr;
+#else
+        for(int i = 0; i < node->count; i++) {
+            if(node->keys[i] == byte) {
+                return &node->children[i];
+            }
+        }
+        return nullptr;
+#endif
+    }
+    case NODE48: {
+        Node48* node = static_cast<Node48*>(inner);
+        if(node->index[byte] != 0) {
+            return &node->children[node->index[byte] - 1];
+        }
+        return nullptr;
+    }
+    default: {
+        Node256* node = static_cast<Node256*>(inner);
+        if(node->children[byte] != nullptr) {
+            return &node->children[byte];
+        }
+        return nullptr;
+    }
+    }
+}
+
+//----------------------------------------------------------------------------
+// addChild
+// Preconditions: Node argument is an inner node without a child for the byte
+// Postconditions: The child is added under the byte; a full node is first
+//                 replaced by one of the next size, updating the pointer
+void RadixTree::addChild(Node*& treeNode, uint8_t byte, Node* child) {
+    switch(treeNode->type) {
+    case NODE4: {
+        Node4* node = static_cast<Node4*>(treeNode);
+        if(node->count < 4) {
+            // Keep the bytes sorted so a walk visits children in order
+            int i = node->count;
+            while(i > 0 && node->keys[i - 1] > byte) {
+                node->keys[i] = node->keys[i - 1];
+                node->children[i] = node->children[i - 1];
+                i--;
+            }
+            node->keys[i] = byte;
+            node->children[i] = child;
+            node->count++;
+            return;
+        }
+        Node16* bigger = new Node16;
+        bigger->type = NODE16;
+        bigger->count = node->count;
+        bigger->prefix.swap(node->prefix);
+        bigger->end = node->end;
+        memcpy(bigger->keys, node->keys, sizeof(node->keys));
+        memcpy(bigger->children, node->children, sizeof(node->children));
+        delete node;
+        treeNode = bigger;
+        break;
+    }
+    case NODE16: {
+        Node16* node = static_cast<Node16*>(treeNode);
+        if(node->count < 16) {
+            int i = node->count;
+            while(i > 0 && node->keys[i - 1] > byte) {
+                node->keys[i] = node->keys[i - 1];
+                node->children[i] = node->children[i - 1];
+                i--;
+            }
+            node->keys[i] = byte;
+            node->children[i] = child;
+            node->count++;
+            return;
+        }
+        Node48* bigger = new Node48;
+        bigger->type = NODE48;
+        bigger->count = node->count;
+        bigger->prefix.swap(node->prefix);
+        bigger->end = node->end;
+        memset(bigger->index, 0, sizeof(bigger->index));
+        for(int i = 0; i < node->count; i++) {
+            bigger->index[node->keys[i]] = static_cast<uint8_t>(i + 1);
+            bigger->children[i] = node->children[i];
+        }
+        delete node;
+        treeNode = bigger;
+        break;
+    }
+    case NODE48: {
+        Node48* node = static_cast<Node48*>(treeNode);
+        if(node->count < 48) {
+            // Slots fill in arrival order, the index keeps the byte order
+            node->children[node->count] = child;
+            node->index[byte] = static_cast<uint8_t>(node->count + 1);
+            node->count++;
+            return;
+        }
+        Node256* bigger = new Node256;
+        bigger->type = NODE256;
+        bigger->count = node->count;
+        bigger->prefix.swap(node->prefix);
+        bigger->end = node->end;
+        for(int b = 0; b < 256; b++) {
+            bigger->children[b] = (node->index[b] != 0 ?
+                node->children[node->index[b] - 1] : nullptr);
+        }
+        delete node;
+        treeNode = bigger;
+        break;
+    }
+    default: {
+        Node256* node = static_cast<Node256*>(treeNode);
+        node->children[byte] = child;
+        node->count++;
+        return;
+    }
+    }
+    // The node was full and has been replaced, add to the bigger one
+    addChild(treeNode, byte, child);
+}
@@ -0,0 +1,163 @@
+//----------------------------------------------------------------------------
+// RADIXTREE.H
+// Class for an adaptive radix tree (holds NodeData objects by their bytes)
+//----------------------------------------------------------------------------
+// Radix tree: stores NodeData objects by the bytes of their strings, one
+// byte per level, so a lookup costs O(key length) and never re-compares the
+// prefix that led to a node. Inner nodes grow through four sizes as they
+// gain children (4, 16, 48 and 256 slots) and chains of single children are
+// folded into a stored prefix:
+//      --allows inserting NodeData objects
+//      --allows retrieving NodeData objects
+//      --allows visiting the objects in sorted order
+//
+// Implementation and assumptions:
+//      --user will pass pointers to NodeData objects to add nodes to the tree
+//      --an object whose string ends at an inner node is kept in that node's
+//        end slot, so no key has to be free of other keys' prefixes
+//      --for <<, tree outputs data in each node followed by a space
+//      --bytes are ordered as unsigned, the same order as NodeData's <
+//----------------------------------------------------------------------------
+
+#ifndef RADIXTREE_H
+#define RADIXTREE_H
+
+#include "nodedata.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+class RadixTree {
+//----------------------------------------------------------------------------
+// operator<<
+// Preconditions: None
+// Postconditions: Nothing outputted if tree is empty, otherwise each NodeData
+//                 object of the tree is put into the ostream in sorted order
+friend ostream &operator<<(ostream&, const RadixTree&);
+
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: Empty tree is created
+RadixTree();
+
+//----------------------------------------------------------------------------
+// Copy constructor
+// Preconditions: None
+// Postconditions: A deep copy of the RadixTree argument is created
+RadixTree(const RadixTree&);
+
+//----------------------------------------------------------------------------
+// Destructor
+// Preconditions: None
+// Postconditions: Every node and NodeData object is deleted
+~RadixTree();
+
+//----------------------------------------------------------------------------
+// operator=
+// Preconditions: None
+// Postconditions: This tree's old contents are deleted and it becomes a deep
+//                 copy of the RadixTree argument
+RadixTree& operator=(const RadixTree&);
+
+//----------------------------------------------------------------------------
+// isEmpty
+// Preconditions: None
+// Postconditions: Returns true if the tree is empty, otherwise false
+bool isEmpty() const;
+
+//----------------------------------------------------------------------------
+// makeEmpty
+// Preconditions: None
+// Postconditions: Every node and NodeData object is deleted
+void makeEmpty();
+
+//----------------------------------------------------------------------------
+// insert
+// Preconditions: NodeData argument is dynamically allocated
+// Postconditions: If an equal object isn't already in the tree, the object is
+//                 added and true is returned, otherwise false is returned and
+//                 the caller still owns the object
+bool insert(NodeData*);
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: second NodeData argument is unallocated and is expected to be
+//                assigned to the found object
+// Postconditions: If the 1st argument is found, the pointer argument points
+//                 at the tree's object and true is returned, otherwise false
+bool retrieve(const NodeData&, NodeData*&) const;
+
+//----------------------------------------------------------------------------
+// flatten
+// Preconditions: None
+// Postconditions: The vector argument is replaced by a copy of every object in
+//                 the tree in sorted order; the tree is left unchanged
+void flatten(vector<NodeData>&) const;
+
+//----------------------------------------------------------------------------
+// getSize
+// Preconditions: None
+// Postconditions: Returns the number of objects in the tree
+int getSize() const;
+
+private:
+    enum NodeType { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+    struct Node {
+        uint8_t type;                   // one of NodeType
+    };
+    struct Leaf : Node {
+        NodeData* data;                 // the stored object
+    };
+    struct Inner : Node {
+        int count;                      // children in use
+        string prefix;                  // bytes every key below shares
+        Leaf* end;                      // key ending right after the
+                                        // prefix, null if none
+    };
+    struct Node4 : Inner {
+        uint8_t keys[4];                // sorted child bytes
+        Node* children[4];
+    };
+    struct Node16 : Inner {
+        uint8_t keys[16];               // sorted child bytes
+        Node* children[16];
+    };
+    struct Node48 : Inner {
+        uint8_t index[256];             // slot + 1 for every byte, 0 if none
+        Node* children[48];
+    };
+    struct Node256 : Inner {
+        Node* children[256];            // indexed by byte directly
+    };
+
+    Node* root;   // root of the tree
+    int size;     // objects in the tree
+
+    Leaf* newLeaf(NodeData*) const;            // leaf for an object
+
+    Node4* newNode4(const string&) const;      // empty inner node with a
+                                               // prefix
+
+    bool insertHelper(Node*&, NodeData*,       // recursive helper for insert
+        size_t);
+
+    Node** findChild(Inner*, uint8_t) const;   // slot holding a byte's child,
+                                               // null if there is none
+
+    void addChild(Node*&, uint8_t, Node*);     // adds a child, growing the
+                                               // node into the next size
+                                               // when it is full
+
+    void visitHelper(const Node*,              // in-order walk collecting
+        vector<const NodeData*>&) const;       // every object
+
+    void makeEmptyHelper(Node*&);              // recursive helper for makeEmpty
+
+    void deleteNode(Node*);                    // frees a node by its type
+};
+
+#endif
@@ -0,0 +1,418 @@
+// Regression tests for the BinTree class.
+// Checks the tree against std::set on random key sets for the operations
+// that relink nodes directly, and exits with a non-zero status if any check
+// fails. Not part of the assignment driver in lab2.cpp.
+
+#include "bintree.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+const int TEST_KEYS = 2000;           // keys per randomized tree
+const int TEST_ROUNDS = 20;           // random trees per test
+
+int failures = 0;                     // checks failed so far
+
+//global function prototypes
+void check(bool, const string&);                   // counts a failed check
+set<string> makeKeySet(int, unsigned);             // random distinct keys
+vector<string> contents(const BinTree&);           // keys, in order
+bool holds(const BinTree&, const set<string>&);    // exactly the set's keys
+void fillTree(BinTree&, const set<string>&);       // one insert per key
+void testBulkLoad();                               // bulkLoad vs std::set
+void testInsertBatch();                            // batches with a filter on
+void testBuilder();                                // sorted streams
+void testSplitJoin();                              // halves and round trips
+void testRemoveRange();                            // ranges vs std::set
+void testSetOperations();                          // union, intersection, diff
+string makeSnapshot(const vector<pair<int, string>>&); // hand-made snapshot
+void testSnapshot();                               // save/load round trips
+
+int main() {
+   testBulkLoad();
+   testInsertBatch();
+   testBuilder();
+   testSplitJoin();
+   testRemoveRange();
+   testSetOperations();
+   testSnapshot();
+   if (failures > 0) {
+      cout << failures << " check(s) failed" << endl;
+      return 1;
+   }
+   cout << "All checks passed" << endl;
+   return 0;
+}
+
+//----------------------------------------------------------------------------
+// check
+// prints the name of a failed check and counts it
+
+void check(bool passed, const string& name) {
+   if (!passed) {
+      cout << "FAIL: " << name << endl;
+      failures++;
+   }
+}
+
+//----------------------------------------------------------------------------
+// makeKeySet
+// distinct tokens of 1 to 4 lowercase letters, so ranges hit many keys
+
+set<string> makeKeySet(int count, unsigned seed) {
+   mt19937 gen(seed);
+   uniform_int_distribution<int> length(1, 4);
+   uniform_int_distribution<int> letter('a', 'z');
+   set<string> keys;
+   for (int i = 0; i < count; i++) {
+      string s(length(gen), ' ');
+      for (char& c : s) {
+         c = static_cast<char>(letter(gen));
+      }
+      keys.insert(s);
+   }
+   return keys;
+}
+
+//----------------------------------------------------------------------------
+// contents
+// the tree's keys in order, the tree is unchanged
+
+vector<string> contents(const BinTree& T) {
+   vector<NodeData> sorted;
+   T.flatten(sorted);
+   vector<string> keys;
+   for (const NodeData& nd : sorted) {
+      keys.push_back(nd.getData());
+   }
+   return keys;
+}
+
+//----------------------------------------------------------------------------
+// holds
+// true if the tree's in-order keys are exactly the set's and every one of
+// them can be retrieved
+
+bool holds(const BinTree& T, const set<string>& expected) {
+   vector<string> keys = contents(T);
+   if (keys.size() != expected.size() ||
+         !equal(keys.begin(), keys.end(), expected.begin())) {
+      return false;
+   }
+   for (const string& key : expected) {
+      NodeData* found;
+      if (!T.retrieve(NodeData(key), found) || found->getData() != key) {
+         return false;
+      }
+   }
+   return true;
+}
+
+//----------------------------------------------------------------------------
+// fillTree
+// inserts every key of the set in a shuffled order
+
+void fillTree(BinTree& T, const set<string>& keys) {
+   vector<string> order(keys.begin(), keys.end());
+   shuffle(order.begin(), order.end(), mt19937(static_cast<unsigned>(
+      keys.size())));
+   for (const string& key : order) {
+      T.insert(new NodeData(key));
+   }
+}
+
+//----------------------------------------------------------------------------
+// testBulkLoad
+// duplicates are dropped, the keys match and the tree is perfectly balanced
+
+void testBulkLoad() {
+   for (int round = 0; round < TEST_ROUNDS; round++) {
+      set<string> keys = makeKeySet(TEST_KEYS, round);
+      vector<NodeData*> batch;
+      for (const string& key : keys) {
+         batch.push_back(new NodeData(key));
+         batch.push_back(new NodeData(key));       // every key twice
+      }
+      shuffle(batch.begin(), batch.end(), mt19937(round));
+      BinTree T;
+      int distinct = T.bulkLoad(batch.data(), static_cast<int>(batch.size()));
+      check(distinct == static_cast<int>(keys.size()), "bulkLoad count");
+      check(holds(T, keys), "bulkLoad keys");
+      int balanced = static_cast<int>(floor(log2(keys.size()))) + 1;
+      check(T.getHeight() == balanced, "bulkLoad height");
+      check(count(batch.begin(), batch.end(), nullptr) ==
+         static_cast<long>(batch.size()), "bulkLoad clears the array");
+   }
+}
+
+//----------------------------------------------------------------------------
+// testInsertBatch
+// every key a batch inserts is found while the Bloom filter grows under it
+
+void testInsertBatch() {
+   for (int round = 0; round < TEST_ROUNDS; round++) {
+      set<string> keys = makeKeySet(TEST_KEYS, 100 + round);
+      BinTree T;
+      T.enableFilter(10);
+      vector<NodeData*> batch;
+      for (const string& key : keys) {
+         batch.push_back(new NodeData(key));
+      }
+      vector<bool> inserted;
+      int added = T.insertBatch(batch.data(), static_cast<int>(batch.size()),
+         inserted);
+      check(added == static_cast<int>(keys.size()), "insertBatch count");
+      check(holds(T, keys), "insertBatch keys with a filter");
+   }
+}
+
+//----------------------------------------------------------------------------
+// testBuilder
+// a sorted stream builds a balanced tree, and plain inserts between adds
+// are kept
+
+void testBuilder() {
+   for (int round = 0; round < TEST_ROUNDS; round++) {
+      set<string> keys = makeKeySet(TEST_KEYS, 200 + round);
+      BinTree T;
+      {
+         BinTree::Builder builder(T);
+         for (const string& key : keys) {
+            builder.add(new NodeData(key));
+         }
+         NodeData duplicate(*keys.begin());
+         NodeData* again = new NodeData(duplicate);
+         check(!builder.add(again), "Builder rejects a duplicate");
+         delete again;
+      }
+      check(holds(T, keys), "Builder keys");
+      int balanced = static_cast<int>(floor(log2(keys.size()))) + 1;
+      check(T.getHeight() <= balanced + 1, "Builder height");
+
+      // Plain inserts of larger keys between adds
+      BinTree U;
+      set<string> expected;
+      {
+         BinTree::Builder builder(U);
+         int i = 0;
+         for (const string& key : keys) {
+            builder.add(new NodeData(key));
+            expected.insert(key);
+            if (++i % 37 == 0) {
+               NodeData* larger = new NodeData(key + "~");
+               if (U.insert(larger)) {
+                  expected.insert(larger->getData());
+               }
+               else {
+                  delete larger;                 // duplicate, not inserted
+               }
+            }
+         }
+      }
+      check(holds(U, expected), "Builder with interleaved inserts");
+   }
+}
+
+//----------------------------------------------------------------------------
+// testSplitJoin
+// each half holds its side of the key, joining restores the tree, and many
+// round trips keep it valid
+
+void testSplitJoin() {
+   for (int round = 0; round < TEST_ROUNDS; round++) {
+      set<string> keys = makeKeySet(TEST_KEYS, 300 + round);
+      BinTree T;
+      T.setRebalancing(0.75);
+      fillTree(T, keys);
+      mt19937 gen(round);
+      for (int trip = 0; trip < 40; trip++) {
+         auto at = keys.begin();
+         advance(at, gen() % keys.size());
+         BinTree left;
+         BinTree right;
+         T.split(NodeData(*at), left, right);
+         check(T.isEmpty(), "split empties the tree");
+         check(holds(left, set<string>(keys.begin(), at)), "split left half");
+         check(holds(right, set<string>(at, keys.end())),
+            "split right half");
+         T.join(left, right);
+         check(left.isEmpty() && right.isEmpty(), "join empties both sides");
+      }
+      check(holds(T, keys), "split/join round trips");
+      // Same tree for both halves is refused and changes nothing
+      BinTree same;
+      T.split(NodeData(*keys.begin()), same, same);
+      check(holds(T, keys) && same.isEmpty(), "split into one tree");
+   }
+}
+
+//----------------------------------------------------------------------------
+// testRemoveRange
+// removed objects come back in order and the rest of the tree is intact
+
+void testRemoveRange() {
+   for (int round = 0; round < TEST_ROUNDS; round++) {
+      set<string> keys = makeKeySet(TEST_KEYS, 400 + round);
+      BinTree T;
+      fillTree(T, keys);
+      mt19937 gen(round);
+      for (int cut = 0; cut < 10; cut++) {
+         string low(1, static_cast<char>('a' + gen() % 26));
+         string high = low + string(1, static_cast<char>('a' + gen() % 26));
+         vector<NodeData*> removed;
+         int count = T.removeRange(NodeData(low), NodeData(high), removed);
+         auto first = keys.lower_bound(low);
+         auto last = keys.upper_bound(high);
+         vector<string> expected(first, last);
+         keys.erase(first, last);
+         bool same = (count == static_cast<int>(expected.size()) &&
+            removed.size() == expected.size());
+         for (size_t i = 0; same && i < removed.size(); i++) {
+            same = (removed[i]->getData() == expected[i]);
+         }
+         check(same, "removeRange objects");
+         for (NodeData* ptr : removed) {
+            delete ptr;
+         }
+      }
+      check(holds(T, keys), "removeRange leaves the rest");
+   }
+}
+
+//----------------------------------------------------------------------------
+// testSetOperations
+// union, intersection and difference match the std::set algorithms
+
+void testSetOperations() {
+   for (int round = 0; round < TEST_ROUNDS; round++) {
+      set<string> first = makeKeySet(TEST_KEYS, 500 + round);
+      set<string> second = makeKeySet(TEST_KEYS, 600 + round);
+      for (int op = 0; op < 3; op++) {
+         BinTree A;
+         BinTree B;
+         BinTree result;
+         fillTree(A, first);
+         fillTree(B, second);
+         set<string> expected;
+         auto out = inserter(expected, expected.end());
+         if (op == 0) {
+            result.setUnion(A, B);
+            set_union(first.begin(), first.end(), second.begin(),
+               second.end(), out);
+         }
+         else if (op == 1) {
+            result.setIntersection(A, B);
+            set_intersection(first.begin(), first.end(), second.begin(),
+               second.end(), out);
+         }
+         else {
+            result.setDifference(A, B);
+            set_difference(first.begin(), first.end(), second.begin(),
+               second.end(), out);
+         }
+         const char* names[] = { "setUnion", "setIntersection",
+            "setDifference" };
+         check(holds(result, expected), names[op]);
+         check(A.isEmpty() && B.isEmpty(),
+            string(names[op]) + " empties its arguments");
+      }
+   }
+}
+
+//----------------------------------------------------------------------------
+// testSnapshot
+// a saved tree loads back with the same shape; damaged or truncated
+// snapshots are refused and leave the tree alone
+
+void testSnapshot() {
+   for (int round = 0; round < TEST_ROUNDS; round++) {
+      set<string> keys = makeKeySet(round == 0 ? 0 : TEST_KEYS, 700 + round);
+      BinTree T;
+      fillTree(T, keys);
+      ostringstream out(ios::binary);
+      check(T.save(out), "snapshot save");
+      string bytes = out.str();
+
+      BinTree L;
+      L.insert(new NodeData("old"));
+      istringstream in(bytes, ios::binary);
+      check(L.load(in), "snapshot load");
+      check(L == T && L.getHeight() == T.getHeight(), "snapshot shape");
+      check(holds(L, keys), "snapshot keys");
+
+      set<string> old;
+      old.insert("old");
+      string damaged = bytes;
+      damaged[damaged.size() / 2] ^= 0x20;
+      BinTree D;
+      D.insert(new NodeData("old"));
+      istringstream bad(damaged, ios::binary);
+      check(!D.load(bad) && holds(D, old), "damaged snapshot refused");
+      istringstream cut(bytes.substr(0, bytes.size() - 1), ios::binary);
+      check(!D.load(cut) && holds(D, old), "truncated snapshot refused");
+   }
+
+   // Snapshots with a good checksum but no valid tree in them
+   set<string> old;
+   old.insert("old");
+   const vector<pair<int, string>> samples[] = {
+      { { 1, "a" }, { 0, "b" }, { 1, "c" } },      // valid: b over a and c
+      { { 1, "a" }, { 0, "c" }, { 1, "b" } },      // keys out of order
+      { { 0, "a" }, { 0, "b" } },                  // two roots
+      { { 2, "a" }, { 0, "b" } },                  // left child too deep
+      { { 0, "a" }, { 2, "b" } },                  // right child too deep
+      { { 1, "a" }, { 1, "b" } }                   // no root
+   };
+   for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+      BinTree D;
+      D.insert(new NodeData("old"));
+      istringstream in(makeSnapshot(samples[i]), ios::binary);
+      bool loaded = D.load(in);
+      if (i == 0) {
+         check(loaded && D.getHeight() == 2, "hand-made snapshot loads");
+      }
+      else {
+         check(!loaded && holds(D, old), "invalid snapshot tree refused");
+      }
+   }
+}
+
+//----------------------------------------------------------------------------
+// makeSnapshot
+// a snapshot of the given depths and keys in BinTree::save's format, as
+// another writer could produce it
+
+string makeSnapshot(const vector<pair<int, string>>& nodes) {
+   string payload;
+   for (const pair<int, string>& node : nodes) {
+      // Depths and lengths here are below 128, one varint byte each
+      payload += static_cast<char>(node.first);
+      payload += static_cast<char>(node.second.size());
+      payload += node.second;
+   }
+   uint64_t sum = 0xcbf29ce484222325ULL;          // 64-bit FNV-1a
+   for (char c : payload) {
+      sum ^= static_cast<unsigned char>(c);
+      sum *= 0x100000001b3ULL;
+   }
+   uint32_t magic = 0x42545245;
+   uint32_t version = 1;
+   uint64_t count = nodes.size();
+   uint64_t bytes = payload.size();
+   char header[32];
+   memcpy(header, &magic, 4);
+   memcpy(header + 4, &version, 4);
+   memcpy(header + 8, &count, 8);
+   memcpy(header + 16, &bytes, 8);
+   memcpy(header + 24, &sum, 8);
+   return string(header, sizeof(header)) + payload;
+}
@@ -0,0 +1,273 @@
+//----------------------------------------------------------------------------
+// TOKENSCANNER.CPP
+// Member function definitions for class TokenScanner
+//----------------------------------------------------------------------------
+// Token scanner: finds every token (bytes between whitespace) of a buffer
+// and every "$$" line terminator, classifying 32 bytes at a time into
+// whitespace bit masks and reading token boundaries off the mask bits
+//
+// Assumptions:
+//      --bit i of a block's mask stands for byte i of the block
+//      --a token start is a non-space byte after a space (or the buffer's
+//        start); a token end is a space byte after a non-space byte
+//      --tokens close in the order they opened, so an end always belongs to
+//        the oldest token still open
+//      --the arrays only grow, so scanning window after window reuses them
+//----------------------------------------------------------------------------
+
+#include "tokenscanner.h"
+#include "bitops.h"
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCAN_SSE2 1
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SCAN_AVX2 1
+#endif
+
+// bytes classified per block
+const size_t BLOCK_SIZE = 32;
+
+// whitespace mask of 32 bytes, one bit per byte, by the scalar loop
+static uint32_t spaceMaskScalar(const char* block) {
+    uint32_t mask = 0;
+    for(size_t i = 0; i < BLOCK_SIZE; i++) {
+        char c = block[i];
+        if(c == ' ' || (c >= '\t' && c <= '\r')) {
+            mask |= (1u << i);
+        }
+    }
+    return mask;
+}
+
+#ifdef SCAN_SSE2
+// whitespace mask of 32 bytes with two 16 byte SSE2 compares
+static uint32_t spaceMaskSse2(const char* block) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i range = _mm_set1_epi8('\r' - '\t');
+    uint32_t mask = 0;
+    for(int half = 0; half < 2; half++) {
+        __m128i bytes = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(block + 16 * half));
+        // \t to \r is one range: (c - \t) as unsigned is at most 4
+        __m128i shifted = _mm_sub_epi8(bytes, tab);
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, range),
+            shifted);
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, space), control);
+        mask |= static_cast<uint32_t>(_mm_movemask_epi8(hits)) << (16 * half);
+    }
+    return mask;
+}
+#endif
+
+#ifdef SCAN_AVX2
+// whitespace mask of 32 bytes with one AVX2 compare, only called when the
+// processor reports AVX2
+__attribute__((target("avx2")))
+static uint32_t spaceMaskAvx2(const char* block) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i range = _mm256_set1_epi8('\r' - '\t');
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    __m256i shifted = _mm256_sub_epi8(bytes, tab);
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, range),
+        shifted);
+    __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), control);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+}
+#endif
+
+// the mask routine in use and its name
+typedef uint32_t (*MaskFunction)(const char*);
+struct MaskChoice {
+    MaskFunction function;
+    const char* mode;
+};
+
+// the fastest mask routine the processor supports
+static MaskChoice bestMask() {
+    MaskChoice choice = { spaceMaskScalar, "scalar" };
+#ifdef SCAN_SSE2
+    choice.function = spaceMaskSse2;
+    choice.mode = "sse2";
+#endif
+#ifdef SCAN_AVX2
+    if(__builtin_cpu_supports("avx2")) {
+        choice.function = spaceMaskAvx2;
+        choice.mode = "avx2";
+    }
+#endif
+    return choice;
+}
+
+// the routine in use, chosen on first use (thread-safe) unless setMode
+// picked one
+static MaskChoice& maskChoice() {
+    static MaskChoice choice = bestMask();
+    return choice;
+}
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A scanner holding no tokens is created
+TokenScanner::TokenScanner() {
+    count = 0;
+}
+
+//----------------------------------------------------------------------------
+// scan
+// Preconditions: the pointer addresses at least the given number of bytes
+// Postconditions: The tokens of the buffer replace any earlier results, in
+//                 order; a "$$" token is also recorded as a terminator.
+//                 Returns the number of tokens
+int TokenScanner::scan(const char* buffer, size_t size) {
+    MaskFunction spaceMask = maskChoice().function;
+    terminators.clear();
+    count = 0;
+    // Bytes before the buffer count as whitespace
+    uint32_t carry = 0;
+    size_t closed = 0;
+    size_t base = 0;
+    for(; base + BLOCK_SIZE <= size; base += BLOCK_SIZE) {
+        reserveBlock();
+        blockHelper(base, spaceMask(buffer + base), carry, closed);
+    }
+    // The tail is padded with spaces, which also ends a last open token
+    if(base < size) {
+        char tail[BLOCK_SIZE];
+        memset(tail, ' ', BLOCK_SIZE);
+        memcpy(tail, buffer + base, size - base);
+        reserveBlock();
+        blockHelper(base, spaceMask(tail), carry, closed);
+        carry = 0;
+    }
+    // Buffer ended inside a token
+    if(carry != 0) {
+        lengths[closed++] = size;
+    }
+    // Lengths were filled in with end offsets, and "$$" is the only two byte
+    // token worth a look
+    for(size_t i = 0; i < count; i++) {
+        lengths[i] -= offsets[i];
+        if(lengths[i] == 2 && buffer[offsets[i]] == '$' &&
+        buffer[offsets[i] + 1] == '$') {
+            terminators.push_back(static_cast<int>(i));
+        }
+    }
+    return static_cast<int>(count);
+}
+
+void TokenScanner::reserveBlock() {
+    // A block starts at most one token per two bytes, round up generously
+    if(offsets.size() < count + BLOCK_SIZE) {
+        offsets.resize(2 * (count + BLOCK_SIZE));
+        lengths.resize(offsets.size());
+    }
+}
+
+void TokenScanner::blockHelper(size_t base, uint32_t space, uint32_t& carry,
+size_t& closed) {
+    uint32_t word = ~space;
+    // Shifting by one lines every byte up with the byte before it
+    uint32_t before = (word << 1) | carry;
+    uint32_t starts = word & ~before;
+    uint32_t ends = space & before;
+    carry = word >> 31;
+    // Starts and ends alternate, so each list can be written on its own:
+    // the k-th end always closes the k-th token
+    while(starts != 0) {
+        offsets[count++] = base + lowestBit(starts);
+        starts &= starts - 1;
+    }
+    while(ends != 0) {
+        lengths[closed++] = base + lowestBit(ends);
+        ends &= ends - 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// scanLine
+// Preconditions: None
+// Postconditions: The next line of the stream (without its '\n') is read into
+//                 the scanner's own buffer and scanned as by scan; getLine
+//                 returns that buffer. Returns false, holding no tokens, if no
+//                 line is left
+bool TokenScanner::scanLine(istream& in) {
+    if(!getline(in, line)) {
+        line.clear();
+        scan(line.data(), 0);
+        return false;
+    }
+    scan(line.data(), line.size());
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: tokens found; the offset and length of one token; every
+//                 offset and every length; token indexes of the "$$"
+//                 terminators; the line read by scanLine; and the
+//                 implementation in use, "avx2", "sse2" or "scalar"
+int TokenScanner::getTokenCount() const {
+    return static_cast<int>(count);
+}
+
+size_t TokenScanner::getOffset(int index) const {
+    return offsets[index];
+}
+
+size_t TokenScanner::getLength(int index) const {
+    return lengths[index];
+}
+
+const size_t* TokenScanner::getOffsets() const {
+    return offsets.data();
+}
+
+const size_t* TokenScanner::getLengths() const {
+    return lengths.data();
+}
+
+const vector<int>& TokenScanner::getTerminators() const {
+    return terminators;
+}
+
+const string& TokenScanner::getLine() const {
+    return line;
+}
+
+const char* TokenScanner::getMode() {
+    return maskChoice().mode;
+}
+
+//----------------------------------------------------------------------------
+// setMode
+// Preconditions: No scan is running on another thread
+// Postconditions: Every scanner uses the named implementation, "avx2", "sse2"
+//                 or "scalar", and true is returned; false if the processor
+//                 or the build lacks it. Meant for testing and benchmarks
+bool TokenScanner::setMode(const string& mode) {
+    MaskChoice best = bestMask();
+    MaskChoice& choice = maskChoice();
+    if(mode == "scalar") {
+        choice.function = spaceMaskScalar;
+        choice.mode = "scalar";
+        return true;
+    }
+#ifdef SCAN_SSE2
+    if(mode == "sse2") {
+        choice.function = spaceMaskSse2;
+        choice.mode = "sse2";
+        return true;
+    }
+#endif
+    if(mode == best.mode) {
+        choice = best;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------
+// TOKENSCANNER.H
+// Class for splitting a buffer of lab2's data format into tokens
+//----------------------------------------------------------------------------
+// Token scanner: finds every token (bytes between whitespace) of a buffer
+// and every "$$" line terminator, classifying 32 bytes at a time into
+// whitespace bit masks and reading token boundaries off the mask bits
+//      --allows scanning a buffer, such as a mapped file or part of one
+//      --allows reading a stream line by line, as setData's callers do
+//      --allows reading token offsets and lengths as arrays
+//      --allows choosing the implementation, for testing
+//
+// Implementation and assumptions:
+//      --whitespace is the same as for >> in the C locale: space, \t, \n,
+//        \v, \f and \r
+//      --AVX2 is used when the compiler can target it and the processor has
+//        it, else SSE2 when available, else a scalar loop; all find the same
+//        tokens
+//      --offsets are relative to the start of the buffer last scanned, and
+//        the buffer must outlive their use
+//----------------------------------------------------------------------------
+
+#ifndef TOKENSCANNER_H
+#define TOKENSCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+using namespace std;
+
+class TokenScanner {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A scanner holding no tokens is created
+TokenScanner();
+
+//----------------------------------------------------------------------------
+// scan
+// Preconditions: the pointer addresses at least the given number of bytes
+// Postconditions: The tokens of the buffer replace any earlier results, in
+//                 order; a "$$" token is also recorded as a terminator.
+//                 Returns the number of tokens
+int scan(const char*, size_t);
+
+//----------------------------------------------------------------------------
+// scanLine
+// Preconditions: None
+// Postconditions: The next line of the stream (without its '\n') is read into
+//                 the scanner's own buffer and scanned as by scan; getLine
+//                 returns that buffer. Returns false, holding no tokens, if no
+//                 line is left
+bool scanLine(istream&);
+
+//----------------------------------------------------------------------------
+// getters
+// Postconditions: tokens found; the offset and length of one token; arrays
+//                 of every offset and every length, getTokenCount long and
+//                 valid until the next scan; token indexes of the "$$"
+//                 terminators; the line read by scanLine; and the
+//                 implementation in use, "avx2", "sse2" or "scalar"
+int getTokenCount() const;
+size_t getOffset(int) const;
+size_t getLength(int) const;
+const size_t* getOffsets() const;
+const size_t* getLengths() const;
+const vector<int>& getTerminators() const;
+const string& getLine() const;
+static const char* getMode();
+
+//----------------------------------------------------------------------------
+// setMode
+// Preconditions: No scan is running on another thread
+// Postconditions: Every scanner uses the named implementation, "avx2", "sse2"
+//                 or "scalar", and true is returned; false if the processor
+//                 or the build lacks it. Meant for testing and benchmarks
+static bool setMode(const string&);
+
+private:
+    vector<size_t> offsets;        // first byte of every token, only the
+                                   // first count are in use
+    vector<size_t> lengths;        // bytes in every token
+    size_t count;                  // tokens found by the last scan
+    vector<int> terminators;       // token indexes of every "$$"
+    string line;                   // buffer scanLine reads into
+
+    void reserveBlock();           // room for one more block's tokens
+
+    void blockHelper(size_t,       // records the token starts and ends a
+        uint32_t, uint32_t&,       // 32 byte block's whitespace mask
+        size_t&);                  // shows, carrying the last byte's state
+};
+
+#endif
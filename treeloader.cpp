@@ -0,0 +1,178 @@
+//----------------------------------------------------------------------------
+// TREELOADER.CPP
+// Member function definitions for class TreeLoader
+//----------------------------------------------------------------------------
+// Tree loader: reads the data file format of lab2 (tokens separated by
+// whitespace, every tree's line ending in "$$") by scanning a MappedFile in
+// place with a TokenScanner, in the role of lab2's buildTree
+//
+// Assumptions:
+//      --whitespace is the same as for >> in the C locale
+//      --every token is copied once, from the mapping into its NodeData
+//      --a token touching the end of a window may go on past it, so it is
+//        left for the next window
+//----------------------------------------------------------------------------
+
+#include "treeloader.h"
+#include <vector>
+
+// bytes scanned per window, grown for a token longer than this
+const size_t WINDOW_SIZE = 1 << 16;
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed loader is created, open must be called before use
+TreeLoader::TreeLoader() {
+    position = 0;
+    windowStart = 0;
+    usable = 0;
+    next = 0;
+}
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: None
+// Postconditions: The named file is mapped and reading starts at its first
+//                 byte; returns false if it can't be opened
+bool TreeLoader::open(const string& path) {
+    position = 0;
+    windowStart = 0;
+    usable = 0;
+    next = 0;
+    return file.open(path);
+}
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: The file is unmapped
+void TreeLoader::close() {
+    file.close();
+    position = 0;
+    windowStart = 0;
+    usable = 0;
+    next = 0;
+}
+
+//----------------------------------------------------------------------------
+// isOpen and atEnd
+// Postconditions: whether a file is open, and whether nothing but
+//                 whitespace is left to read in it
+bool TreeLoader::isOpen() const {
+    return file.isOpen();
+}
+
+bool TreeLoader::atEnd() const {
+    if(next < usable) {
+        return false;
+    }
+    // Past the window, look for anything but whitespace
+    const char* bytes = file.getData();
+    size_t size = file.getSize();
+    for(size_t i = position; i < size; i++) {
+        char c = bytes[i];
+        if(c != ' ' && (c < '\t' || c > '\r')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// nextToken
+// Preconditions: File is open
+// Postconditions: If a token is left, the pointer argument is set to its
+//                 first byte in the mapping, the length argument to its
+//                 length, and true is returned; "$$" is returned as a token.
+//                 Otherwise false is returned
+bool TreeLoader::nextToken(const char*& token, size_t& length) {
+    if(next == usable && !nextWindow()) {
+        return false;
+    }
+    token = file.getData() + windowStart + scanner.getOffset(next);
+    length = scanner.getLength(next);
+    next++;
+    return true;
+}
+
+bool TreeLoader::nextWindow() {
+    const char* bytes = file.getData();
+    size_t size = file.getSize();
+    size_t window = WINDOW_SIZE;
+    while(position < size) {
+        size_t end = (size - position > window ? position + window : size);
+        int count = scanner.scan(bytes + position, end - position);
+        windowStart = position;
+        next = 0;
+        usable = count;
+        // The last token may go on past the window, scan it again next time
+        if(end < size && count > 0 && scanner.getOffset(count - 1) +
+        scanner.getLength(count - 1) == end - position) {
+            usable = count - 1;
+        }
+        if(usable > 0) {
+            position = windowStart + (usable < count ?
+                scanner.getOffset(usable) : end - windowStart);
+            return true;
+        }
+        if(count == 0) {
+            // Only whitespace, move on
+            position = end;
+        }
+        else {
+            // One token fills the window, widen it
+            window *= 2;
+        }
+    }
+    usable = 0;
+    next = 0;
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// loadRecord
+// Preconditions: File is open
+// Postconditions: Tokens up to the next "$$" (or the end of the file) are
+//                 added to the tree like buildTree does, inserted one at a
+//                 time in file order so the tree gets the same shape, or, when
+//                 the flag is true, merged in one balanced insertBatch.
+//                 Duplicates are deleted. Returns the number of objects added
+int TreeLoader::loadRecord(BinTree& tree) {
+    return loadRecord(tree, false);
+}
+
+int TreeLoader::loadRecord(BinTree& tree, bool balanced) {
+    const char* token;
+    size_t length;
+    int added = 0;
+    vector<NodeData*> batch;
+    while(nextToken(token, length)) {
+        // End of one line
+        if(length == 2 && token[0] == '$' && token[1] == '$') {
+            break;
+        }
+        NodeData* ptr = new NodeData(token, length);
+        if(balanced) {
+            batch.push_back(ptr);
+        }
+        else if(tree.insert(ptr)) {
+            added++;
+        }
+        else {
+            delete ptr;                // duplicate case, not inserted
+        }
+    }
+    if(!batch.empty()) {
+        vector<bool> inserted;
+        added = tree.insertBatch(batch.data(), static_cast<int>(batch.size()),
+            inserted);
+        // Duplicates are left in the batch
+        for(size_t i = 0; i < batch.size(); i++) {
+            if(!inserted[i]) {
+                delete batch[i];
+            }
+        }
+    }
+    return added;
+}
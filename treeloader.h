@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------
+// TREELOADER.H
+// Class for building trees straight from a mapped data file
+//----------------------------------------------------------------------------
+// Tree loader: reads the data file format of lab2 (tokens separated by
+// whitespace, every tree's line ending in "$$") by scanning a MappedFile in
+// place with a TokenScanner, in the role of lab2's buildTree
+//      --allows reading the file token by token
+//      --allows building one tree per line, in file order or balanced
+//
+// Implementation and assumptions:
+//      --whitespace is the same as for >> in the C locale: space, \t, \n,
+//        \v, \f and \r
+//      --every token is copied once, from the mapping into its NodeData
+//      --the file is scanned a window at a time, so the token arrays stay
+//        small however large the file is
+//      --a last token ending exactly at the end of the file still counts,
+//        where buildTree would drop it with the eof
+//----------------------------------------------------------------------------
+
+#ifndef TREELOADER_H
+#define TREELOADER_H
+
+#include "bintree.h"
+#include "mappedfile.h"
+#include "tokenscanner.h"
+#include <cstddef>
+#include <string>
+using namespace std;
+
+class TreeLoader {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: A closed loader is created, open must be called before use
+TreeLoader();
+
+//----------------------------------------------------------------------------
+// open
+// Preconditions: None
+// Postconditions: The named file is mapped and reading starts at its first
+//                 byte; returns false if it can't be opened
+bool open(const string&);
+
+//----------------------------------------------------------------------------
+// close
+// Preconditions: None
+// Postconditions: The file is unmapped
+void close();
+
+//----------------------------------------------------------------------------
+// isOpen and atEnd
+// Postconditions: whether a file is open, and whether nothing but
+//                 whitespace is left to read in it
+bool isOpen() const;
+bool atEnd() const;
+
+//----------------------------------------------------------------------------
+// nextToken
+// Preconditions: File is open
+// Postconditions: If a token is left, the pointer argument is set to its
+//                 first byte in the mapping, the length argument to its
+//                 length, and true is returned; "$$" is returned as a token.
+//                 Otherwise false is returned
+bool nextToken(const char*&, size_t&);
+
+//----------------------------------------------------------------------------
+// loadRecord
+// Preconditions: File is open
+// Postconditions: Tokens up to the next "$$" (or the end of the file) are
+//                 added to the tree like buildTree does, inserted one at a
+//                 time in file order so the tree gets the same shape, or, when
+//                 the flag is true, merged in one balanced insertBatch.
+//                 Duplicates are deleted. Returns the number of objects added
+int loadRecord(BinTree&);
+int loadRecord(BinTree&, bool);
+
+private:
+    MappedFile file;           // the data file
+    size_t position;           // first byte not yet scanned
+    TokenScanner scanner;      // tokens of the current window
+    size_t windowStart;        // file offset the window's offsets are from
+    int usable;                // window tokens known to be whole
+    int next;                  // next window token to return
+
+    bool nextWindow();         // scans from position until a whole token
+                               // is found, false at the end of the file
+};
+
+#endif
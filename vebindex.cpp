@@ -0,0 +1,154 @@
+//----------------------------------------------------------------------------
+// VEBINDEX.CPP
+// Member function definitions for class VebIndex
+//----------------------------------------------------------------------------
+// van Emde Boas index: a snapshot of a BinTree with the same shape, stored in
+// one array in van Emde Boas order
+//
+// Assumptions:
+//      --the index holds its own copies, later changes to the tree are not
+//        seen until the index is built again
+//----------------------------------------------------------------------------
+
+#include "vebindex.h"
+#include <algorithm>
+#include <unordered_map>
+
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: An empty index is created
+VebIndex::VebIndex() {
+}
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: An index holding a copy of the BinTree argument, same
+//                 shape and objects, is created; the tree is unchanged
+VebIndex::VebIndex(const BinTree& tree) {
+    build(tree);
+}
+
+//----------------------------------------------------------------------------
+// build
+// Preconditions: None
+// Postconditions: The index's old contents are replaced by a copy of the
+//                 BinTree argument
+void VebIndex::build(const BinTree& tree) {
+    // Order the nodes first, then give every node its slot
+    vector<const BinTree::Node*> order;
+    layoutHelper(tree.root, heightHelper(tree.root), order);
+    unordered_map<const BinTree::Node*, int> slot;
+    slot.reserve(order.size());
+    for(size_t i = 0; i < order.size(); i++) {
+        slot[order[i]] = static_cast<int>(i);
+    }
+    entries.clear();
+    entries.reserve(order.size());
+    for(const BinTree::Node* node : order) {
+        Entry entry;
+        entry.data = *node->data;
+        entry.left = (node->left != nullptr ? slot[node->left] : -1);
+        entry.right = (node->right != nullptr ? slot[node->right] : -1);
+        entries.push_back(entry);
+    }
+}
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: None
+// Postconditions: If the NodeData argument is in the index, the pointer
+//                 argument points at the index's copy and true is returned,
+//                 otherwise it is set to nullptr and false is returned
+bool VebIndex::retrieve(const NodeData& toFind,
+const NodeData*& toReturn) const {
+    int cur = (entries.empty() ? -1 : 0);
+    while(cur != -1) {
+        const Entry& entry = entries[cur];
+        if(entry.data == toFind) {
+            toReturn = &entry.data;
+            return true;
+        }
+        cur = (toFind < entry.data ? entry.left : entry.right);
+    }
+    toReturn = nullptr;
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// getParent
+// Preconditions: None
+// Postconditions: Parent node's data is copied into 2nd NodeData argument and
+//                 true is returned if the 1st NodeData argument is in the
+//                 index AND it has a parent, otherwise false is returned
+bool VebIndex::getParent(const NodeData& toFind, NodeData& toReturn) const {
+    // The parent is the node visited just before the match
+    int parent = -1;
+    int cur = (entries.empty() ? -1 : 0);
+    while(cur != -1) {
+        const Entry& entry = entries[cur];
+        if(entry.data == toFind) {
+            if(parent == -1) {
+                return false;
+            }
+            toReturn = entries[parent].data;
+            return true;
+        }
+        parent = cur;
+        cur = (toFind < entry.data ? entry.left : entry.right);
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------
+// getSize
+// Preconditions: None
+// Postconditions: Returns the number of objects in the index
+int VebIndex::getSize() const {
+    return static_cast<int>(entries.size());
+}
+
+void VebIndex::layoutHelper(const BinTree::Node* subtree, int levels,
+vector<const BinTree::Node*>& order) {
+    // Base case, nothing left to place
+    if(subtree == nullptr || levels <= 0) {
+        return;
+    }
+    if(levels == 1) {
+        order.push_back(subtree);
+        return;
+    }
+    // Lay out the top half of the levels as one recursive block, then each
+    // subtree hanging below it as its own block, left to right
+    int bottom = levels / 2;
+    int top = levels - bottom;
+    layoutHelper(subtree, top, order);
+    vector<const BinTree::Node*> roots;
+    depthHelper(subtree, top, roots);
+    for(const BinTree::Node* root : roots) {
+        layoutHelper(root, bottom, order);
+    }
+}
+
+void VebIndex::depthHelper(const BinTree::Node* subtree, int depth,
+vector<const BinTree::Node*>& found) {
+    // Base case, node doesn't exist
+    if(subtree == nullptr) {
+        return;
+    }
+    if(depth == 0) {
+        found.push_back(subtree);
+        return;
+    }
+    depthHelper(subtree->left, depth - 1, found);
+    depthHelper(subtree->right, depth - 1, found);
+}
+
+int VebIndex::heightHelper(const BinTree::Node* subtree) {
+    // Base case, an empty subtree has no levels
+    if(subtree == nullptr) {
+        return 0;
+    }
+    return 1 + max(heightHelper(subtree->left), heightHelper(subtree->right));
+}
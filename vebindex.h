@@ -0,0 +1,90 @@
+//----------------------------------------------------------------------------
+// VEBINDEX.H
+// Class for a read-only copy of a BinTree in van Emde Boas layout
+//----------------------------------------------------------------------------
+// van Emde Boas index: a snapshot of a BinTree with the same shape, stored in
+// one array in van Emde Boas order. The top half of the levels is laid out
+// first, then every subtree hanging below it, each arranged the same way, so
+// any block size holds whole small subtrees and a lookup touches about
+// log_B(n) blocks at every level of the memory hierarchy without tuning
+//      --allows retrieving NodeData objects
+//      --allows the retrieval of parent nodes
+//
+// Implementation and assumptions:
+//      --the copy keeps the tree's shape, so getParent answers as the tree
+//        does; balanced trees (arrayToBSTree, bulkLoad, Builder) benefit most
+//      --the index holds its own copies, later changes to the tree are not
+//        seen until the index is built again
+//----------------------------------------------------------------------------
+
+#ifndef VEBINDEX_H
+#define VEBINDEX_H
+
+#include "nodedata.h"
+#include "bintree.h"
+#include <vector>
+using namespace std;
+
+class VebIndex {
+public:
+//----------------------------------------------------------------------------
+// Default constructor
+// Preconditions: None
+// Postconditions: An empty index is created
+VebIndex();
+
+//----------------------------------------------------------------------------
+// Constructor
+// Preconditions: None
+// Postconditions: An index holding a copy of the BinTree argument, same
+//                 shape and objects, is created; the tree is unchanged
+explicit VebIndex(const BinTree&);
+
+//----------------------------------------------------------------------------
+// build
+// Preconditions: None
+// Postconditions: The index's old contents are replaced by a copy of the
+//                 BinTree argument
+void build(const BinTree&);
+
+//----------------------------------------------------------------------------
+// retrieve
+// Preconditions: None
+// Postconditions: If the NodeData argument is in the index, the pointer
+//                 argument points at the index's copy and true is returned,
+//                 otherwise it is set to nullptr and false is returned
+bool retrieve(const NodeData&, const NodeData*&) const;
+
+//----------------------------------------------------------------------------
+// getParent
+// Preconditions: None
+// Postconditions: Parent node's data is copied into 2nd NodeData argument and
+//                 true is returned if the 1st NodeData argument is in the
+//                 index AND it has a parent, otherwise false is returned
+bool getParent(const NodeData&, NodeData&) const;
+
+//----------------------------------------------------------------------------
+// getSize
+// Preconditions: None
+// Postconditions: Returns the number of objects in the index
+int getSize() const;
+
+private:
+    struct Entry {
+        NodeData data;  // copy of the tree node's object
+        int left;       // index of the left child, -1 if none
+        int right;      // index of the right child, -1 if none
+    };
+    vector<Entry> entries;   // nodes in van Emde Boas order, root first
+
+    void layoutHelper(const BinTree::Node*,    // appends the top levels of a
+        int, vector<const BinTree::Node*>&);   // subtree in van Emde Boas
+                                               // order
+
+    void depthHelper(const BinTree::Node*,     // collects the nodes a given
+        int, vector<const BinTree::Node*>&);   // depth below a subtree root
+
+    int heightHelper(const BinTree::Node*);    // levels in a subtree
+};
+
+#endif